@@ -0,0 +1,342 @@
+// TokenizerBench.cpp
+//
+// Tokenizer micro-benchmark: runs every tokenizer kernel and strategy over synthetic
+// in-memory buffers, so tokenizer changes can be judged without file I/O, threads or the
+// index. Buffers alternate tokens and delimiter runs whose lengths follow a chosen
+// distribution, and every (token length, delimiter run) profile is timed separately.
+//
+// Each measurement is repeated until it is stable: at least --min-runs times, then until
+// the coefficient of variation of the samples drops below --target-cv, --max-runs is
+// reached or --max-seconds have been spent on it. The buffer is restored from a pristine
+// copy before every run (outside the timed region), because in-place kernels overwrite
+// delimiters. With --count-only the counting kernels are timed instead: the same scans
+// with a sink that stores no tokens.
+
+#include <algorithm>     // For std::min
+#include <chrono>
+#include <cmath>         // For std::sqrt
+#include <cstdint>       // For uint64_t
+#include <cstdlib>       // For std::strtoull, std::strtod
+#include <cstring>       // For memcpy
+#include <iomanip>       // For std::setw, std::setprecision
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <x86intrin.h>   // For __rdtsc
+
+#include "TokenClasses.hpp"
+#include "TokenizerKernels.hpp"
+#include "TokenizerStrategies.hpp"
+
+namespace {
+
+struct BenchOptions {
+    size_t bufferBytes = 16 * 1024 * 1024;
+    std::vector<double> tokenLengths = {2, 6, 16, 64};  // Mean token length of each profile
+    std::vector<double> delimiterRuns = {1, 4};         // Mean delimiter run of each profile
+    std::string distribution = "geometric";             // geometric, uniform or fixed
+    std::vector<std::string> kernels;                   // Empty = all
+    bool countOnly = false;                             // Time the counting kernels
+    int minRuns = 5;
+    int maxRuns = 100;
+    double targetCv = 0.01;
+    double maxSeconds = 3.0;
+    uint64_t seed = 42;
+};
+
+// Same classification as the engine's default class: ASCII letters and digits are
+// token characters
+void initializeCharDict(char charDict[256]) {
+    buildCharTable("alnum", charDict);
+}
+
+// A length with the given mean, at least 1
+size_t drawLength(std::mt19937_64& random, const std::string& distribution, double mean) {
+    if (distribution == "fixed") {
+        return std::max<size_t>(1, static_cast<size_t>(mean + 0.5));
+    }
+    if (distribution == "uniform") {
+        std::uniform_int_distribution<size_t> uniform(1, std::max<size_t>(1, static_cast<size_t>(2 * mean - 1)));
+        return uniform(random);
+    }
+    // Geometric on 1, 2, 3, ... with the requested mean
+    std::geometric_distribution<size_t> geometric(1.0 / std::max(1.0, mean));
+    return 1 + geometric(random);
+}
+
+// Fill a buffer with tokens and delimiter runs, returns the number of tokens
+size_t generateBuffer(std::vector<char>& buffer, const BenchOptions& options,
+                      double tokenLength, double delimiterRun) {
+    static const char tokenChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    static const char delimiterChars[] = " \n\t.,;:-()'\"!?";
+    std::mt19937_64 random(options.seed);
+    std::uniform_int_distribution<size_t> tokenChar(0, sizeof(tokenChars) - 2);
+    std::uniform_int_distribution<size_t> delimiterChar(0, sizeof(delimiterChars) - 2);
+
+    buffer.resize(options.bufferBytes);
+    size_t position = 0;
+    size_t tokens = 0;
+    while (position < buffer.size()) {
+        size_t length = std::min(drawLength(random, options.distribution, tokenLength), buffer.size() - position);
+        for (size_t i = 0; i < length; ++i) {
+            buffer[position++] = tokenChars[tokenChar(random)];
+        }
+        tokens++;
+        size_t run = std::min(drawLength(random, options.distribution, delimiterRun), buffer.size() - position);
+        for (size_t i = 0; i < run; ++i) {
+            buffer[position++] = delimiterChars[delimiterChar(random)];
+        }
+    }
+    return tokens;
+}
+
+struct Sample {
+    double seconds;
+    uint64_t cycles;
+};
+
+struct Summary {
+    double mean;
+    double stddev;
+};
+
+Summary summarize(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    double mean = sum / values.size();
+    double squares = 0.0;
+    for (double value : values) {
+        squares += (value - mean) * (value - mean);
+    }
+    double stddev = values.size() > 1 ? std::sqrt(squares / (values.size() - 1)) : 0.0;
+    return {mean, stddev};
+}
+
+// Time one kernel until the measurement is stable; returns false if it reported a
+// different number of tokens than the generator wrote
+bool benchKernel(const std::string& name, const TokenizerKernelSet& kernelSet, const std::vector<char>& pristine,
+                 size_t expectedTokens, const char charDict[256], const NibbleTables& tables,
+                 const BenchOptions& options) {
+    std::vector<char> work(pristine.size());
+    std::vector<char*> tokens;
+    tokens.reserve(expectedTokens);
+    std::vector<Sample> samples;
+    std::vector<double> secondsPerRun;
+    size_t tokenCount = 0;
+    double spent = 0.0;
+
+    // One run of the kernel under test; returns the number of tokens it reported
+    auto run = [&]() -> size_t {
+        if (options.countOnly) {
+            return kernelSet.countTokens(work.data(), work.size(), charDict, tables);
+        }
+        tokens.clear();
+        kernelSet.tokenize(work.data(), work.size(), charDict, tables, tokens);
+        return tokens.size();
+    };
+
+    // Untimed warm-up: faults in the work buffer and grows the token vector
+    memcpy(work.data(), pristine.data(), pristine.size());
+    run();
+
+    while (true) {
+        memcpy(work.data(), pristine.data(), pristine.size());
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t cycleStart = __rdtsc();
+        tokenCount = run();
+        uint64_t cycleEnd = __rdtsc();
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+        samples.push_back({duration.count(), cycleEnd - cycleStart});
+        secondsPerRun.push_back(duration.count());
+        spent += duration.count();
+
+        int runs = static_cast<int>(samples.size());
+        if (runs < options.minRuns) {
+            continue;
+        }
+        Summary summary = summarize(secondsPerRun);
+        if (summary.stddev / summary.mean <= options.targetCv || runs >= options.maxRuns || spent >= options.maxSeconds) {
+            break;
+        }
+    }
+
+    std::vector<double> nsPerByte;
+    std::vector<double> cyclesPerByte;
+    std::vector<double> tokensPerSecond;
+    for (const Sample& sample : samples) {
+        nsPerByte.push_back(sample.seconds * 1e9 / pristine.size());
+        cyclesPerByte.push_back(static_cast<double>(sample.cycles) / pristine.size());
+        tokensPerSecond.push_back(tokenCount / sample.seconds);
+    }
+    Summary ns = summarize(nsPerByte);
+    Summary cycles = summarize(cyclesPerByte);
+    Summary rate = summarize(tokensPerSecond);
+
+    std::cout << "  " << std::left << std::setw(20) << name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(9) << ns.mean << " ns/byte +- " << std::setw(5)
+              << std::setprecision(1) << 100.0 * ns.stddev / ns.mean << "%"
+              << std::setprecision(3) << std::setw(9) << cycles.mean << " cycles/byte +- " << std::setw(5)
+              << std::setprecision(1) << 100.0 * cycles.stddev / cycles.mean << "%"
+              << std::scientific << std::setprecision(3) << std::setw(12) << rate.mean << " tokens/s"
+              << std::defaultfloat << "  (" << samples.size() << " runs)";
+    bool correct = tokenCount == expectedTokens;
+    if (!correct) {
+        std::cout << "  WRONG: " << tokenCount << " tokens, expected " << expectedTokens;
+    }
+    std::cout << std::endl;
+    return correct;
+}
+
+std::vector<double> parseNumbers(const std::string& value) {
+    std::vector<double> numbers;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        numbers.push_back(std::strtod(item.c_str(), nullptr));
+    }
+    return numbers;
+}
+
+std::vector<std::string> parseNames(const std::string& value) {
+    std::vector<std::string> names;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        names.push_back(item);
+    }
+    return names;
+}
+
+// Parse one "--name=value" option, returns false if it is not recognized
+bool parseOption(const std::string& arg, BenchOptions& options) {
+    if (arg.rfind("--", 0) != 0) {
+        return false;
+    }
+    // Options without "=value" are switches
+    size_t equals = arg.find('=');
+    std::string name = arg.substr(2, equals == std::string::npos ? std::string::npos : equals - 2);
+    std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+
+    if (name == "size-mb") {
+        options.bufferBytes = std::strtoull(value.c_str(), nullptr, 10) * 1024 * 1024;
+        return options.bufferBytes > 0;
+    }
+    if (name == "token-lengths") {
+        options.tokenLengths = parseNumbers(value);
+        return !options.tokenLengths.empty();
+    }
+    if (name == "delimiter-runs") {
+        options.delimiterRuns = parseNumbers(value);
+        return !options.delimiterRuns.empty();
+    }
+    if (name == "distribution") {
+        options.distribution = value;
+        return value == "geometric" || value == "uniform" || value == "fixed";
+    }
+    if (name == "kernels") {
+        options.kernels = parseNames(value);
+        return true;
+    }
+    if (name == "count-only" && value.empty()) {
+        options.countOnly = true;
+        return true;
+    }
+    if (name == "min-runs") {
+        options.minRuns = std::max(2, std::atoi(value.c_str()));
+        return true;
+    }
+    if (name == "max-runs") {
+        options.maxRuns = std::max(2, std::atoi(value.c_str()));
+        return true;
+    }
+    if (name == "target-cv") {
+        options.targetCv = std::strtod(value.c_str(), nullptr);
+        return true;
+    }
+    if (name == "max-seconds") {
+        options.maxSeconds = std::strtod(value.c_str(), nullptr);
+        return true;
+    }
+    if (name == "seed") {
+        options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (!parseOption(argv[i], options)) {
+            std::cerr << "Usage: " << argv[0] << " [options]" << std::endl;
+            std::cerr << "Options:" << std::endl;
+            std::cerr << "       --size-mb=N             synthetic buffer size in MB (default 16)" << std::endl;
+            std::cerr << "       --token-lengths=L,...   mean token lengths, one profile each (default 2,6,16,64)" << std::endl;
+            std::cerr << "       --delimiter-runs=D,...  mean delimiter run lengths (default 1,4)" << std::endl;
+            std::cerr << "       --distribution=NAME     length distribution: geometric, uniform, fixed (default geometric)" << std::endl;
+            std::cerr << "       --kernels=K,...         kernels to run, e.g. branchless/avx2,strtok (default all)" << std::endl;
+            std::cerr << "       --count-only            time the counting kernels, which store no tokens" << std::endl;
+            std::cerr << "       --min-runs=N            runs before checking stability (default 5)" << std::endl;
+            std::cerr << "       --max-runs=N            most runs per measurement (default 100)" << std::endl;
+            std::cerr << "       --target-cv=X           stop once stddev/mean is at most X (default 0.01)" << std::endl;
+            std::cerr << "       --max-seconds=S         time budget per measurement (default 3)" << std::endl;
+            std::cerr << "       --seed=N                generator seed (default 42)" << std::endl;
+            return 1;
+        }
+    }
+
+    char charDict[256];
+    initializeCharDict(charDict);
+    NibbleTables tables = buildNibbleTables(charDict);
+
+    // Every kernel the CPU can run, then the other strategies
+    std::vector<std::pair<std::string, TokenizerKernelSet>> kernels;
+    __builtin_cpu_init();
+    kernels.emplace_back("branchless/scalar", selectTokenizerKernels("scalar", "alnum"));
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.emplace_back("branchless/avx2", selectTokenizerKernels("avx2", "alnum"));
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        kernels.emplace_back("branchless/avx512", selectTokenizerKernels("avx512", "alnum"));
+    }
+    for (const std::string& strategy : tokenizerStrategyNames()) {
+        if (strategy != "branchless") {
+            kernels.emplace_back(strategy, selectTokenizer(strategy, "scalar", "alnum"));
+        }
+    }
+    if (!options.kernels.empty()) {
+        std::vector<std::pair<std::string, TokenizerKernelSet>> selected;
+        for (const auto& kernel : kernels) {
+            if (std::find(options.kernels.begin(), options.kernels.end(), kernel.first) != options.kernels.end()) {
+                selected.push_back(kernel);
+            }
+        }
+        kernels = selected;
+    }
+
+    std::cout << "Tokenizer micro-benchmark: " << options.bufferBytes << " byte buffers, "
+              << options.distribution << " lengths, " << (options.countOnly ? "counting only, " : "")
+              << "cycles are TSC reference cycles" << std::endl;
+
+    bool allCorrect = true;
+    std::vector<char> pristine;
+    for (double tokenLength : options.tokenLengths) {
+        for (double delimiterRun : options.delimiterRuns) {
+            size_t tokens = generateBuffer(pristine, options, tokenLength, delimiterRun);
+            std::cout << "Profile: mean token length " << tokenLength << ", mean delimiter run " << delimiterRun
+                      << " (" << tokens << " tokens)" << std::endl;
+            for (const auto& [name, kernel] : kernels) {
+                allCorrect &= benchKernel(name, kernel, pristine, tokens, charDict, tables, options);
+            }
+        }
+    }
+    return allCorrect ? 0 : 1;
+}
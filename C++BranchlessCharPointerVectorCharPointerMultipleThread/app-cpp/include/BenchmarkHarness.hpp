@@ -0,0 +1,49 @@
+#ifndef BENCHMARKHARNESS_HPP
+#define BENCHMARKHARNESS_HPP
+
+#include <string>
+#include <vector>
+
+#include "ProcessingEngine.hpp"
+
+// Configurations a sweep runs
+struct SweepSpec {
+    std::vector<int> threadCounts;        // Empty = powers of two up to the CPU count
+    std::vector<int> affinityFlags = {0, 1};
+    int repeat = 3;                       // Runs per configuration
+    bool coldCache = true;                // Evict the dataset from the page cache before every run
+    std::string output = "results.json";
+};
+
+// Scaling sweep: indexes the same dataset with every (thread count, affinity) pair, each
+// run with a new engine and an empty index, and writes the results as JSON. The page
+// cache is emptied per file with posix_fadvise, which needs no privileges (unlike
+// writing to /proc/sys/vm/drop_caches). Engine output is suppressed during the runs;
+// one progress line per run is printed instead.
+class BenchmarkHarness {
+public:
+    explicit BenchmarkHarness(const EngineOptions& options);
+
+    // Run the sweep over the dataset at path. Returns false and sets error if the
+    // results cannot be written.
+    bool sweep(const std::string& path, const SweepSpec& spec, std::string& error);
+
+    // Set one "name=value" field of a spec, returns false if the name or value is invalid
+    static bool parseSetting(const std::string& setting, SweepSpec& spec);
+
+private:
+    struct RunResult {
+        int threads;
+        int affinity;
+        int run;
+        IndexRunStats stats;
+    };
+
+    void evictFromPageCache(const std::vector<CrawledFile>& files);
+    bool writeResults(const std::string& path, const SweepSpec& spec, const std::vector<CrawledFile>& files,
+                      const std::vector<RunResult>& results, std::string& error);
+
+    EngineOptions options;
+};
+
+#endif // BENCHMARKHARNESS_HPP
@@ -0,0 +1,129 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>       // For size_t
+#include <cstdint>       // For intptr_t
+#include <memory>
+#include <thread>        // For std::this_thread::yield
+#include <utility>       // For std::move
+
+// Bounded lock-free multi-producer / multi-consumer ring buffer.
+//
+// Each slot carries a sequence number that tells producers and consumers whether
+// the slot is free for the current lap of the ring, so push and pop only need a
+// single compare-and-swap on the shared head or tail counter. Producers call close()
+// once they have pushed everything; pop() then drains the remaining items and
+// returns false, which gives consumers an explicit end-of-stream signal.
+template <typename T>
+class BoundedQueue {
+public:
+    // Capacity is rounded up to the next power of two
+    explicit BoundedQueue(size_t requestedCapacity) {
+        capacity = 2;
+        while (capacity < requestedCapacity) {
+            capacity <<= 1;
+        }
+        mask = capacity - 1;
+        slots.reset(new Slot[capacity]);
+        for (size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Try to enqueue an item, returns false if the ring is full
+    bool tryPush(T& item) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(item);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Slot still holds an item from the previous lap
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Try to dequeue an item, returns false if the ring is currently empty
+    bool tryPop(T& item) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(slot.value);
+                    slot.sequence.store(pos + capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Producer has not published this slot yet
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Enqueue an item, spinning while the ring is full (backpressure on producers)
+    void push(T item) {
+        while (!tryPush(item)) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Dequeue an item, waiting for producers until the queue is closed and drained.
+    // Returns false only at end of stream.
+    bool pop(T& item) {
+        while (true) {
+            if (tryPop(item)) {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                // Everything pushed before close() is visible now, so one more attempt decides
+                return tryPop(item);
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    // Signal that no more items will be pushed
+    void close() {
+        closed.store(true, std::memory_order_release);
+    }
+
+    // True once the queue is closed and every item has been consumed
+    bool isDrained() const {
+        if (!closed.load(std::memory_order_acquire)) {
+            return false;
+        }
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // Keep the hot counters on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<bool> closed{false};
+    size_t capacity;
+    size_t mask;
+    std::unique_ptr<Slot[]> slots;
+};
+
+#endif // BOUNDEDQUEUE_HPP
@@ -0,0 +1,70 @@
+#ifndef BUFFERPOOL_HPP
+#define BUFFERPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>       // For size_t
+#include <map>
+#include <mutex>
+#include <utility>       // For std::pair
+#include <vector>
+
+// Where the pages of file buffers are placed
+enum class MemPolicy {
+    Local,                // Bound to the NUMA node of the loader that fills the buffer
+    Interleave,           // Interleaved page by page across all nodes
+    FirstTouchByConsumer  // Left untouched so the worker that reads the file places it
+};
+
+// Pool of reusable file buffers bounded by a memory budget.
+//
+// Loaders acquire a buffer for every file and block while the budget is exhausted;
+// workers release the buffer once the file is tokenized so it can be recycled for
+// the next file of the same size class and node. A budget of 0 means unlimited.
+// Buffers come from libnuma according to the memory policy and are page aligned.
+class BufferPool {
+public:
+    BufferPool(size_t budgetBytes, MemPolicy policy);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Get a buffer of at least size bytes for a loader on the given node, waiting for
+    // workers if over budget. The real capacity is returned through capacity and must be
+    // passed to release() together with the same node.
+    char* acquire(size_t size, int node, size_t& capacity);
+
+    // Like acquire() but returns nullptr instead of waiting when over budget
+    char* tryAcquire(size_t size, int node, size_t& capacity);
+
+    // Return a buffer to the pool and wake up waiting loaders. Under first-touch-by-consumer
+    // buffers are freed instead of cached, so every acquire hands out untouched pages.
+    void release(char* buffer, int node, size_t capacity);
+
+    // Give up a buffer that may still be written to, e.g. by a read the kernel has not
+    // finished: it is never handed out again nor freed, but stops counting against the
+    // budget so loaders cannot wait for it forever
+    void abandon(size_t capacity);
+
+    size_t budgetBytes() const { return budget; }
+    size_t peakResidentBytes();
+
+private:
+    static size_t sizeClass(size_t size);
+    char* acquireBuffer(size_t size, int node, size_t& capacity, bool wait);
+    char* allocate(size_t capacity, int node);
+    void deallocate(char* buffer, size_t capacity);
+    bool evictOne();
+
+    std::mutex poolMutex;
+    std::condition_variable bufferReleased;
+    size_t budget;              // Maximum bytes held by the pool (0 = unlimited)
+    MemPolicy policy;           // Page placement of new buffers
+    bool numaAvailable;         // False if libnuma cannot be used on this system
+    size_t residentBytes = 0;   // Bytes currently allocated (in use and cached)
+    size_t inUseBytes = 0;      // Bytes currently handed out to loaders/workers
+    size_t peakResident = 0;    // High-water mark of residentBytes
+    std::map<std::pair<int, size_t>, std::vector<char*>> freeBuffers;  // Cached buffers by (node, capacity)
+};
+
+#endif // BUFFERPOOL_HPP
@@ -0,0 +1,49 @@
+#ifndef CORPUSGENERATOR_HPP
+#define CORPUSGENERATOR_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t, uintmax_t
+#include <string>
+
+// Shape of a synthetic dataset
+struct CorpusSpec {
+    size_t fileCount = 1000;
+    size_t meanFileBytes = 64 * 1024;
+    std::string sizeDistribution = "lognormal";  // lognormal, uniform or fixed
+    size_t vocabularySize = 50000;               // Distinct words
+    double zipfSkew = 1.0;                       // Word rank r is drawn with weight 1 / r^skew
+    int directoryDepth = 2;                      // Directory levels above the files
+    int directoryFanout = 8;                     // Subdirectories per directory
+    uint64_t seed = 42;
+};
+
+// What generate() wrote
+struct CorpusStats {
+    size_t files = 0;
+    size_t directories = 0;
+    uintmax_t bytes = 0;
+    double seconds = 0.0;
+};
+
+// Synthetic text corpus generator, so the engine can be benchmarked without downloading
+// a dataset. Files are lines of words drawn from a generated vocabulary with a Zipf
+// distribution (as natural language roughly is), separated by spaces and punctuation.
+// Every file is generated from its own seed (spec seed plus file number), so the corpus
+// is identical whatever the number of threads used to write it.
+class CorpusGenerator {
+public:
+    CorpusGenerator(const CorpusSpec& spec, int numThreads);
+
+    // Write the corpus below root (created if missing). Returns false and sets error if
+    // a directory or file cannot be written.
+    bool generate(const std::string& root, CorpusStats& stats, std::string& error);
+
+    // Set one "name=value" field of a spec, returns false if the name or value is invalid
+    static bool parseSetting(const std::string& setting, CorpusSpec& spec);
+
+private:
+    CorpusSpec spec;
+    int numThreads;
+};
+
+#endif // CORPUSGENERATOR_HPP
@@ -0,0 +1,64 @@
+#ifndef DIRECTORYCRAWLER_HPP
+#define DIRECTORYCRAWLER_HPP
+
+#include <condition_variable>
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uintmax_t, int64_t, uint64_t
+#include <mutex>
+#include <string>
+#include <vector>
+
+// A regular file found by the crawl, with what fstatat said about it
+struct CrawledFile {
+    std::string path;
+    uintmax_t size;
+    int64_t modifiedNs;          // Modification time in nanoseconds since the epoch
+    uint64_t inode;
+};
+
+// Multi-threaded dataset crawler.
+//
+// Directories waiting to be scanned sit on a shared stack; every crawler thread pops
+// one, reads it with getdents64 and pushes the subdirectories it finds. Entries are
+// classified from d_type, so only regular files are stat'ed (fstatat relative to the
+// open directory, for their size, modification time and inode). Subdirectories are opened with openat on the parent
+// descriptor while it is still open. Names starting with '.' are pruned as they are
+// found, which skips hidden files and whole hidden subtrees.
+class DirectoryCrawler {
+public:
+    explicit DirectoryCrawler(int numThreads);
+
+    DirectoryCrawler(const DirectoryCrawler&) = delete;
+    DirectoryCrawler& operator=(const DirectoryCrawler&) = delete;
+
+    // Collect every visible regular file below root
+    std::vector<CrawledFile> crawl(const std::string& root);
+
+    size_t directoriesScanned() const { return directoryCount; }
+
+private:
+    // A directory waiting to be scanned. fd is -1 if it must be opened by path because
+    // too many descriptors were already held by queued directories.
+    struct PendingDirectory {
+        int fd;
+        std::string path;
+    };
+
+    // Upper bound on descriptors held open by queued directories
+    static constexpr size_t maxOpenDirectories = 256;
+
+    void crawlWorker(std::vector<CrawledFile>& files);
+    void scanDirectory(PendingDirectory& directory,
+                       std::vector<char>& entryBuffer,
+                       std::vector<CrawledFile>& files);
+
+    int numThreads;
+    std::mutex stackMutex;
+    std::condition_variable directoryQueued;
+    std::vector<PendingDirectory> pending;  // Directories not yet scanned
+    size_t activeScans = 0;                 // Directories being scanned right now
+    size_t openDirectories = 0;             // Descriptors held by queued directories
+    size_t directoryCount = 0;              // Directories scanned so far
+};
+
+#endif // DIRECTORYCRAWLER_HPP
@@ -0,0 +1,111 @@
+#ifndef INDEXIMAGE_HPP
+#define INDEXIMAGE_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint32_t, uint64_t
+#include <memory>
+#include <string>
+
+#include "PostingsCodec.hpp"
+
+// On-disk index image. Every section starts at an 8-byte aligned offset and holds
+// fixed-size little-endian records, so a mapped file is queried in place:
+//
+//   header | documents | terms | term slots | postings words | strings
+//
+// Documents and terms point into the strings section. Term slots form an open-addressing
+// table (linear probing, at most half full) of term numbers plus one, probed from
+// hashTerm(); postings are the words of each term's compressed list exactly as
+// PostingsView reads them. The checksum is a CRC32C of everything after the header.
+constexpr char indexImageMagic[8] = {'F', 'R', 'E', 'I', 'N', 'D', 'E', 'X'};
+constexpr uint32_t indexImageVersion = 2;
+
+struct IndexImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint64_t fileBytes;
+    uint32_t checksum;
+    uint32_t reserved;
+    uint64_t documentCount;     // Including deleted documents, which keep their ids
+    uint64_t liveDocumentCount;
+    uint64_t termCount;
+    uint64_t termSlotCount;     // Power of two
+    uint64_t documentsOffset;   // ImageDocument[documentCount]
+    uint64_t termsOffset;       // ImageTerm[termCount]
+    uint64_t slotsOffset;       // uint32_t[termSlotCount], 0 marks an empty slot
+    uint64_t postingsOffset;    // uint32_t words
+    uint64_t stringsOffset;     // Term and path bytes
+};
+
+struct ImageDocument {
+    uint64_t pathOffset;        // Into the strings section
+    uint64_t pathLength;
+    uint64_t size;              // DocumentIdentity the document was indexed with
+    int64_t modifiedNs;
+    uint64_t inode;
+    uint64_t live;              // 0 once the file was deleted
+};
+
+struct ImageTerm {
+    uint64_t hash;              // hashTerm() of the term
+    uint64_t termOffset;        // Into the strings section
+    uint32_t termLength;
+    uint32_t postingCount;
+    uint64_t postingsOffset;    // In words, into the postings section
+    uint64_t postingsWords;
+};
+
+// CRC32C (Castagnoli), with the SSE4.2 instruction when the CPU has it
+uint32_t crc32c(const void* data, size_t size);
+
+// Read-only memory-mapped index image
+class IndexImage {
+public:
+    ~IndexImage();
+
+    IndexImage(const IndexImage&) = delete;
+    IndexImage& operator=(const IndexImage&) = delete;
+
+    // Map and validate an image (magic, version, bounds and checksum). Returns nullptr and
+    // sets error if the file cannot be used.
+    static std::unique_ptr<IndexImage> open(const std::string& path, std::string& error);
+
+    size_t documentCount() const { return header->documentCount; }
+    size_t liveDocumentCount() const { return header->liveDocumentCount; }
+    size_t termCount() const { return header->termCount; }
+    size_t fileBytes() const { return header->fileBytes; }
+    const void* data() const { return mapping; }
+
+    std::string getDocument(size_t documentNumber) const;
+    const ImageDocument& documentRecord(size_t documentNumber) const { return documents[documentNumber]; }
+
+    // Postings of a term, returns false if the term is not in the image
+    bool findPostings(const char* term, size_t length, uint64_t hash, PostingsView& postings) const;
+
+    // Call function(term, length, hash, postings, words, wordCount) for every term, where
+    // words/wordCount are the encoded postings behind the view
+    template <typename Function>
+    void forEachTerm(Function function) const {
+        for (uint64_t i = 0; i < header->termCount; ++i) {
+            const ImageTerm& term = terms[i];
+            const uint32_t* postingsWords = postings + term.postingsOffset;
+            function(strings + term.termOffset, term.termLength, term.hash,
+                     PostingsView(postingsWords, term.postingCount), postingsWords, term.postingsWords);
+        }
+    }
+
+private:
+    IndexImage() = default;
+
+    void* mapping = nullptr;
+    size_t mappingBytes = 0;
+    const IndexImageHeader* header = nullptr;
+    const ImageDocument* documents = nullptr;
+    const ImageTerm* terms = nullptr;
+    const uint32_t* slots = nullptr;
+    const uint32_t* postings = nullptr;
+    const char* strings = nullptr;
+};
+
+#endif // INDEXIMAGE_HPP
@@ -0,0 +1,189 @@
+#ifndef INDEXSTORE_HPP
+#define INDEXSTORE_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "IndexImage.hpp"
+#include "PostingsCodec.hpp"
+#include "TermArena.hpp"
+#include "TermDictionary.hpp"
+
+using PostingsTable = TermDictionary<std::vector<DocFreqPair>>;
+
+// Postings of a term in the index: compressed once merged; pending only holds postings
+// while a merge is collecting them from the workers' tables
+struct TermPostings {
+    CompressedPostings compressed;
+    std::vector<DocFreqPair> pending;
+};
+
+// What identifies the indexed version of a file: if any of it changes, the file is
+// indexed again
+struct DocumentIdentity {
+    uintmax_t size = 0;
+    int64_t modifiedNs = 0;      // Modification time in nanoseconds since the epoch
+    uint64_t inode = 0;
+
+    bool operator==(const DocumentIdentity& other) const {
+        return size == other.size && modifiedNs == other.modifiedNs && inode == other.inode;
+    }
+};
+
+// Number of hash partitions of the term space, selected by the top bits of the term hash
+constexpr int indexPartitionBits = 8;
+constexpr size_t indexPartitionCount = size_t(1) << indexPartitionBits;
+
+inline size_t termPartition(uint64_t hash) {
+    return static_cast<size_t>(hash >> (64 - indexPartitionBits));
+}
+
+// Term -> postings table owned by one worker thread while indexing. It is split into
+// the same hash partitions as the IndexStore so the merge can hand whole partitions
+// to different threads without any locking. Term bytes are copied into the worker's
+// own arena, so they outlive the file buffer the tokens pointed into.
+class LocalTermTable {
+public:
+    LocalTermTable() : partitions(indexPartitionCount) {}
+
+    // Count one occurrence of a term in a document
+    void addTerm(const char* term, size_t length, long documentNumber) {
+        uint64_t hash = hashTerm(term, length);
+        std::vector<DocFreqPair>& postings = partitions[termPartition(hash)].findOrInsert(term, length, hash, arena);
+        // A worker sees all tokens of a file (or chunk) back to back
+        if (!postings.empty() && postings.back().documentNumber == documentNumber) {
+            postings.back().wordFrequency++;
+        } else {
+            postings.push_back({documentNumber, 1});
+        }
+    }
+
+    PostingsTable& partition(size_t index) { return partitions[index]; }
+
+private:
+    std::vector<PostingsTable> partitions;
+    TermArena arena;
+};
+
+// In-memory inverted index, the C++ counterpart of the Java IndexStore.
+//
+// Documents are registered once with putDocument() and get dense ids in registration
+// order. Terms live in open-addressing dictionaries keyed by a precomputed hash, with
+// their bytes in per-partition arenas. Terms are hash-partitioned: during indexing every worker fills its own
+// LocalTermTable, and at the end mergePartition() folds partition p of all local tables
+// into partition p of the index. Different partitions are merged by different threads
+// in parallel. After a merge the postings of every term are sorted by document number
+// with one entry per document (chunks of one file counted by two workers are summed)
+// and stored as CompressedPostings.
+//
+// Every document remembers the DocumentIdentity it was indexed with, so a later build
+// only indexes new and changed files. A changed file keeps its id; its old postings are
+// retired and dropped by the next merge, as are those of files that were deleted.
+//
+// The index can be saved as an IndexImage and loaded back by mapping the file: queries
+// then read the image in place, and only the next index build copies it into the
+// in-memory tables (materializeImage()).
+class IndexStore {
+public:
+    IndexStore();
+
+    IndexStore(const IndexStore&) = delete;
+    IndexStore& operator=(const IndexStore&) = delete;
+
+    // Register a document to be indexed, returns its id (the existing id if already
+    // registered). If the document was indexed before, its old postings are retired.
+    long putDocument(const std::string& documentPath, const DocumentIdentity& identity);
+
+    // Whether a document is indexed with exactly this identity
+    bool isCurrent(const std::string& documentPath, const DocumentIdentity& identity);
+
+    // Retire every indexed document below root whose path is not in present (the files
+    // deleted since it was indexed), returns how many were retired
+    size_t removeMissingDocuments(const std::string& root, const std::unordered_set<std::string>& present);
+
+    // Forget the retired documents once every partition has been merged
+    void clearRetiredDocuments();
+
+    // Id of a registered document, or -1 if unknown
+    long findDocument(const std::string& documentPath);
+
+    // Path of a document id
+    std::string getDocument(long documentNumber);
+
+    // Move partition p of every local table into the index and drop the postings of
+    // retired documents. Callers merging different partitions may run concurrently.
+    void mergePartition(size_t partition, std::vector<LocalTermTable>& localTables);
+
+    // Postings of a term sorted by document number, empty if the term is not indexed
+    std::vector<DocFreqPair> lookupIndex(const std::string& term);
+
+    // Compressed postings of a term, returns false if the term is not indexed. The view
+    // stays valid until the next merge or load, so it is only for use between index
+    // builds (the search command).
+    bool findPostings(const std::string& term, PostingsView& postings);
+
+    size_t documentCount();   // Documents currently indexed (not deleted)
+    size_t termCount();
+    size_t partitionTermCount(size_t partition);
+
+    // Memory used to store the terms: term bytes in the arenas, bytes the arenas have
+    // allocated (at least one block per partition in use) and dictionary slot/control bytes
+    void termStorageBytes(size_t& arenaBytesUsed, size_t& arenaBytesReserved, size_t& tableBytes);
+
+    // Number of postings and bytes of their compressed form
+    void postingsStorage(size_t& postingCount, size_t& compressedBytes);
+
+    // Decode every postings list once (for the decode throughput report), returns the postings decoded
+    size_t decodeAllPostings();
+
+    // Write the index as an image file (written to path + ".tmp", then renamed over path).
+    // Returns false and sets error on failure. Not safe while an index build is running.
+    bool save(const std::string& path, std::string& error);
+
+    // Replace the index with a mapped image file. Returns false and sets error (keeping
+    // the current index) if the file is not a valid image.
+    bool load(const std::string& path, std::string& error);
+
+    // Copy a loaded image into the in-memory tables and unmap it, so documents and terms
+    // can be added again. Does nothing if no image is loaded.
+    void materializeImage();
+
+    // Bytes of the loaded image, 0 if the index is in memory
+    size_t imageBytes() const { return image ? image->fileBytes() : 0; }
+
+private:
+    struct DocumentRecord {
+        std::string path;
+        DocumentIdentity identity;
+        bool live;                     // False once the file was deleted
+    };
+
+    struct Partition {
+        std::mutex partitionMutex;
+        TermDictionary<TermPostings> termInvertedIndex;  // Term -> postings
+        TermArena termArena;              // Bytes of the terms in this partition
+    };
+
+    static void normalizePostings(std::vector<DocFreqPair>& postings);
+
+    std::mutex documentMutex;
+    std::unordered_map<std::string, long> documentMap;  // Path -> document number
+    std::vector<DocumentRecord> documents;              // Document number -> path and identity
+    size_t liveDocuments = 0;
+
+    // Documents whose stored postings the next merge drops (read-only during a merge)
+    std::vector<bool> retiredDocuments;
+    size_t retiredCount = 0;
+
+    std::vector<Partition> partitions;
+
+    std::unique_ptr<IndexImage> image;  // Set while the index is a loaded image
+};
+
+#endif // INDEXSTORE_HPP
@@ -0,0 +1,77 @@
+#ifndef IOURING_HPP
+#define IOURING_HPP
+
+#include <bitset>
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t
+#include <vector>
+#include <linux/io_uring.h>
+
+// Minimal io_uring wrapper over the raw system calls (no liburing dependency).
+//
+// One instance is owned by a single loader thread: it hands out submission queue
+// entries, submits them in batches and reaps completions. init() fails cleanly on
+// kernels or sandboxes without io_uring so the caller can fall back to read(), and
+// supportsOp() tells whether the kernel implements an opcode: io_uring itself dates
+// from 5.1, but e.g. OPENAT, READ, FADVISE and CLOSE only from 5.6.
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Set up a ring with room for at least entries submissions, returns false if unavailable
+    bool init(unsigned entries);
+
+    // True if the kernel supports opcode (IORING_OP_*). Kernels too old to answer the
+    // probe (before 5.6) report no opcode as supported.
+    bool supportsOp(uint8_t opcode) const { return supportedOps.test(opcode); }
+
+    // Next free submission entry (zeroed). Prepared entries are submitted early if the
+    // queue is full; returns nullptr only if the kernel still has not consumed them.
+    io_uring_sqe* getSqe();
+
+    // count free submission entries at once (e.g. for a linked chain), or none: returns
+    // false without reserving anything if the queue has no room for all of them
+    bool getSqes(io_uring_sqe** sqesOut, unsigned count);
+
+    // Submit all prepared entries and wait for at least waitCount completions
+    int submitAndWait(unsigned waitCount);
+
+    // Take back every entry the kernel has not consumed yet (prepared, or published by a
+    // submit that failed), appending their user data; they will never run
+    void withdrawUnconsumed(std::vector<uint64_t>& userData);
+
+    // Pop one completion if available
+    bool popCompletion(uint64_t& userData, int& result);
+
+private:
+    // Ask the kernel which opcodes it implements (IORING_REGISTER_PROBE)
+    void probeOps();
+
+    int ringFd = -1;
+    std::bitset<256> supportedOps;
+
+    // Submission queue
+    void* sqRing = nullptr;
+    size_t sqRingSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+    unsigned pendingSubmit = 0;  // Entries prepared since the last submit
+
+    // Completion queue
+    void* cqRing = nullptr;
+    size_t cqRingSize = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+};
+
+#endif // IOURING_HPP
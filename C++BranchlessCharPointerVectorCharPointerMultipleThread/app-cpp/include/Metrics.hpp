@@ -0,0 +1,99 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t, uintmax_t
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Latency histogram with HDR-style log-linear buckets: values below 32 get a bucket
+// each, every larger power of two is split into 32 equal buckets, so any recorded
+// value is reported within 1/32 (about 3%) of its true value with a fixed 15 KB of
+// counts, whatever the range. Not thread-safe: each thread records into its own.
+class LatencyHistogram {
+public:
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? minimum : 0; }
+    uint64_t max() const { return maximum; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    // Smallest value v such that at least percentile% of the recorded values are <= v,
+    // as the highest value of its bucket (capped at the maximum recorded)
+    uint64_t valueAtPercentile(double percentile) const;
+
+private:
+    static constexpr int subBucketBits = 5;
+    static constexpr int subBucketCount = 1 << subBucketBits;
+    static constexpr int bucketCount = (64 - subBucketBits + 1) * subBucketCount;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketHighest(int index);
+
+    uint64_t counts[bucketCount] = {};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t minimum = UINT64_MAX;
+    uint64_t maximum = 0;
+};
+
+// What one worker did during an index run. Workers record only the histogram; the
+// counters are filled in from the statistics registry when the run is reported.
+struct WorkerMetrics {
+    uintmax_t files = 0;              // Files (or chunks of large files) processed
+    uintmax_t bytes = 0;
+    uintmax_t tokens = 0;
+    uintmax_t readBytes = 0;          // Bytes of files the worker read itself (first-touch-by-consumer)
+    double queueWaitSeconds = 0.0;    // Time spent finding work: ring, own deque, stealing, idling
+    double tokenizeSeconds = 0.0;
+    double indexSeconds = 0.0;        // Time spent counting terms into the local table
+    LatencyHistogram fileLatency;     // Tokenize + count time per file or chunk, in nanoseconds
+};
+
+// What one loader thread did during an index run
+struct LoaderMetrics {
+    int node = 0;
+    uintmax_t files = 0;
+    uintmax_t bytes = 0;
+    LatencyHistogram loadLatency;     // Open to fully read (or mapped) per file, in nanoseconds
+};
+
+// Metrics of one indexFiles call. Crawl, sort and merge run alone and are wall-clock
+// seconds; loading overlaps the workers, so load is the wall-clock time until the last
+// loader finished, and queue wait, tokenize and index are summed over the workers.
+struct RunMetrics {
+    std::string path;
+    int threads = 0;
+    int affinity = 0;
+    std::string tokenizer;            // Name of the tokenizer kernel that ran
+    std::string loader;
+    size_t files = 0;
+    uintmax_t bytes = 0;
+    uintmax_t tokens = 0;
+    size_t terms = 0;
+
+    double crawlSeconds = 0.0;
+    double sortSeconds = 0.0;         // Change detection, sort by size and document registration
+    double loadSeconds = 0.0;
+    double queueWaitSeconds = 0.0;
+    double tokenizeSeconds = 0.0;
+    double indexSeconds = 0.0;
+    double mergeSeconds = 0.0;
+    double totalSeconds = 0.0;        // Load, tokenize and merge (excludes crawl and sort)
+
+    std::vector<WorkerMetrics> workers;
+    std::vector<LoaderMetrics> loaders;
+};
+
+// JSON string literal of value, with quotes and escapes
+std::string jsonString(const std::string& value);
+
+// Write the metrics as one JSON object, or as CSV rows of "scope,id,metric,value"
+// (scope run, phase, worker or loader) that load into a table without reshaping
+void writeMetricsJson(const RunMetrics& metrics, std::ostream& out);
+void writeMetricsCsv(const RunMetrics& metrics, std::ostream& out);
+
+#endif // METRICS_HPP
@@ -0,0 +1,61 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t
+#include <string>
+
+// Hardware events counted around the tokenize loop
+enum PerfEvent {
+    PerfCycles,
+    PerfInstructions,
+    PerfBranchMisses,
+    PerfL1dMisses,
+    PerfLlcMisses,
+    PerfStalledCycles,
+    perfEventCount
+};
+
+// Counts of one thread, or summed over threads. An event is valid only if its counter
+// could be opened (and, for a sum, was open on every thread that contributed).
+struct PerfCounts {
+    uint64_t values[perfEventCount] = {};
+    bool valid[perfEventCount] = {};
+    bool any = false;            // True once counts from at least one thread were added
+
+    void add(const PerfCounts& other);
+};
+
+// Hardware counters of the calling thread, opened with perf_event_open and counting user
+// space only (what perf_event_paranoid=2 allows without privileges). Each event has its
+// own counter rather than a group, so an event the CPU or hypervisor does not support
+// does not cost the others, and counts are scaled for multiplexing when the PMU has
+// fewer counters than events. Counters start disabled and only count between start()
+// and stop(), so a worker can count the tokenize loop and nothing else.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Whether any counter could be opened; if not, error says why
+    bool available() const { return openCount > 0; }
+    const std::string& error() const { return openError; }
+
+    void start();
+    void stop();
+
+    // Counts accumulated by all start()/stop() intervals so far
+    PerfCounts read() const;
+
+    static const char* eventName(int event);
+
+private:
+    int fds[perfEventCount];
+    int openCount = 0;
+    std::string openError;
+};
+
+#endif // PERFCOUNTERS_HPP
@@ -0,0 +1,74 @@
+#ifndef POSTINGSCODEC_HPP
+#define POSTINGSCODEC_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint32_t
+#include <vector>
+
+// One posting: a document and how often the term occurs in it
+struct DocFreqPair {
+    long documentNumber;
+    long wordFrequency;
+};
+
+// Read-only view of one compressed postings list, either owned by a CompressedPostings
+// or inside a memory-mapped index image.
+//
+// Layout of words: a skip table with (last document, word offset) for every block,
+// then the blocks. A full block is one header word (bit widths) followed by the
+// document gaps and the frequencies minus one, each bit-packed in the 4-lane vertical
+// layout of SIMD-BP128: lane l of each 128-bit word holds values l, l + 4, l + 8, ...
+// so one SSE2 shift/mask step unpacks four consecutive values. A final partial block
+// is variable-byte encoded, which suits the many short lists of rare terms. Gaps are
+// taken from the previous block's last document, so every block decodes on its own.
+class PostingsView {
+public:
+    static constexpr size_t blockSize = 128;
+
+    PostingsView() = default;
+    PostingsView(const uint32_t* words, uint32_t count) : words(words), count(count) {}
+
+    // Append every posting to postings
+    void decode(std::vector<DocFreqPair>& postings) const;
+
+    // Decode one block into documents/frequencies (blockSize entries each), returns its length
+    size_t decodeBlock(size_t block, uint32_t* documents, uint32_t* frequencies) const;
+
+    size_t size() const { return count; }
+    size_t blockCount() const { return (count + blockSize - 1) / blockSize; }
+    uint32_t blockLastDocument(size_t block) const { return words[2 * block]; }
+
+private:
+    const uint32_t* words = nullptr;
+    uint32_t count = 0;
+};
+
+// Postings list of one term compressed in blocks of 128 entries (see PostingsView)
+class CompressedPostings {
+public:
+    static constexpr size_t blockSize = PostingsView::blockSize;
+
+    // Replace the contents with postings sorted by document number
+    void encode(const std::vector<DocFreqPair>& postings);
+
+    // Replace the contents with an already encoded list (e.g. from an index image)
+    void assign(uint32_t count, const uint32_t* words, size_t wordCount);
+
+    PostingsView view() const { return PostingsView(words.data(), count); }
+
+    // Append every posting to postings
+    void decode(std::vector<DocFreqPair>& postings) const { view().decode(postings); }
+
+    size_t size() const { return count; }
+    const uint32_t* data() const { return words.data(); }
+    size_t wordCount() const { return words.size(); }
+
+    // Bytes of the compressed representation
+    size_t memoryBytes() const { return words.size() * sizeof(uint32_t); }
+
+private:
+    uint32_t count = 0;
+    std::vector<uint32_t> words;
+};
+
+#endif // POSTINGSCODEC_HPP
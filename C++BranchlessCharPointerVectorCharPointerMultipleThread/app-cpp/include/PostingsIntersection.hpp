@@ -0,0 +1,37 @@
+#ifndef POSTINGSINTERSECTION_HPP
+#define POSTINGSINTERSECTION_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint32_t
+#include <string>
+#include <vector>
+
+#include "PostingsCodec.hpp"
+
+// Position of the first document >= target in documents[position, count), or count.
+// documents is one decoded block, so it is sorted.
+typedef size_t (*BlockSeekKernel)(const uint32_t* documents, size_t position, size_t count, uint32_t target);
+
+// One document at a time
+size_t seekScalar(const uint32_t* documents, size_t position, size_t count, uint32_t target);
+
+// Eight documents per AVX2 compare: the number of lanes below the target is how far to advance
+size_t seekAvx2(const uint32_t* documents, size_t position, size_t count, uint32_t target);
+
+// Pick the seek kernel: auto/avx2/avx512 use AVX2 when the CPU has it, scalar forces the
+// portable loop (follows the --simd option of the tokenizer)
+BlockSeekKernel selectBlockSeekKernel(const std::string& requested);
+
+// Postings at least this many times longer than the candidate list are galloped over
+constexpr size_t gallopingRatio = 32;
+
+// Intersect candidates (sorted by document) with the compressed postings of one more term.
+// Candidates that also occur in postings are kept in order with the term's frequency added
+// to their wordFrequency; the others are dropped. Blocks whose last document is below the
+// next candidate are skipped using the skip table without being decoded, by galloping when
+// postings is much longer than candidates and by stepping otherwise; a block is decoded
+// (with SIMD) only when a candidate may be in it.
+void intersectPostings(std::vector<DocFreqPair>& candidates, const PostingsView& postings,
+                       BlockSeekKernel seek);
+
+#endif // POSTINGSINTERSECTION_HPP
@@ -4,58 +4,218 @@
 #include <memory>
 #include <vector>
 #include <string>
-#include <queue>
 #include <mutex>
 #include <utility>       // For std::pair
 #include <cstddef>       // For size_t
 #include <cstdint>       // For uintmax_t
 #include <filesystem>    // For std::filesystem::path
 
+#include "BoundedQueue.hpp"
+#include "BufferPool.hpp"
+#include "DirectoryCrawler.hpp"
+#include "WorkDeque.hpp"
+#include "TokenizerKernels.hpp"
+#include "TokenizerStrategies.hpp"
+#include "IndexStore.hpp"
+#include "PostingsIntersection.hpp"
+#include "PerfCounters.hpp"
+#include "Metrics.hpp"
+#include "StatsRegistry.hpp"
+
+#include <atomic>
+#include <condition_variable>
+
+// Pooled buffer holding one loaded file, shared by all chunks of that file
+struct FileBuffer {
+    char* data;                     // Start of the file content
+    size_t capacity;                // Capacity of the pooled buffer
+    int node;                       // Node the buffer was acquired for
+    bool mapped;                    // Memory-mapped file (--input=mmap): unmapped instead of pooled
+    std::atomic<int> pendingChunks; // Chunks not yet tokenized; the last one releases the buffer
+    long documentNumber;            // Id of the file in the index store
+};
+
 struct FileData {
     std::string path;           // Path to the file
-    std::vector<char*> content; // Content of the file as a vector of char pointers
-    size_t size;                // Size of the file content
+    std::vector<char*> content; // Content of the file (or chunk) as a vector of char pointers
+    size_t size;                // Size of the file (or chunk) content
+    FileBuffer* buffer;         // Buffer the content points into
+    bool readByConsumer;        // Content not loaded yet: the worker reads it (first-touch-by-consumer)
+};
+
+// Counters kept by each loader thread for the load phase report
+struct LoaderStats {
+    size_t filesLoaded = 0;    // Files handed to the workers
+    size_t chunkedFiles = 0;   // Files larger than the chunk size
+    size_t totalChunks = 0;    // Chunks created from those files
+    size_t ioOperations = 0;   // open/read/fadvise/close operations issued
+    size_t directFiles = 0;    // Files read with O_DIRECT
+    size_t bufferedFallbacks = 0; // Files where O_DIRECT was refused and buffered reads were used
+    uintmax_t bytesLoaded = 0; // Bytes read from files
+    LatencyHistogram loadLatency; // Nanoseconds from open to fully read (or mapped), per file
+};
+
+// Optional settings given on the command line after the thread count and affinity flag
+struct EngineOptions {
+    size_t maxResidentBytes = 0;  // Memory budget for loaded file buffers (0 = unlimited)
+    std::string tokenizer = "branchless";  // Tokenizer strategy: branchless, strtok or regex
+    std::string simd = "auto";    // Tokenizer kernel: auto, scalar, avx2 or avx512
+    std::string tokenChars = "alnum";  // Token character class (see TokenClasses.hpp)
+    size_t chunkBytes = 64 * 1024 * 1024;  // Files larger than this are split into chunks (0 = never)
+    MemPolicy memPolicy = MemPolicy::Local;  // Page placement of loader buffers
+    bool verifyPlacement = false; // Check with move_pages where tokenized bytes live
+    std::string input = "read";   // Input mode: read (copy into buffers) or mmap (zero-copy, read-only)
+    bool mmapPopulate = false;    // Prefault mapped files with MAP_POPULATE
+    std::string loader = "sync";  // File loader: sync (read per file) or uring (io_uring)
+    unsigned ioDepth = 32;        // Files in flight per node with the io_uring loader
+    bool directIo = false;        // Read with O_DIRECT into aligned buffers, bypassing the page cache
+    bool perfCounters = false;    // Count hardware events around the tokenize loop with perf_event_open
+    std::string metrics;          // Structured metrics after each index run: json or csv (empty = none)
+    std::string metricsOutput;    // File the metrics are written to (empty = standard output)
+    unsigned progressSeconds = 0; // Print indexing progress this often (0 = never)
+};
+
+// Summary of one indexFiles call, for benchmark harnesses
+struct IndexRunStats {
+    size_t files = 0;            // Files loaded (new or changed)
+    uintmax_t bytes = 0;         // Bytes tokenized
+    uintmax_t tokens = 0;
+    size_t terms = 0;            // Distinct terms in the index afterwards
+    double crawlSeconds = 0.0;
+    double mergeSeconds = 0.0;
+    double totalSeconds = 0.0;   // Load, tokenize and merge (excludes the crawl)
+    double throughputMBps = 0.0;
 };
 
 class ProcessingEngine {
 public:
-    // Constructor accepting number of threads and affinity flag
-    ProcessingEngine(int numThreads, int affinityFlag);
+    // Constructor accepting number of threads, affinity flag and optional settings
+    ProcessingEngine(int numThreads, int affinityFlag, const EngineOptions& options = EngineOptions());
     
     // Public methods
-    void indexFiles(const std::string& path);
-    void searchFiles(); // Placeholder for future implementation
+    IndexRunStats indexFiles(const std::string& path);
+    void searchFiles(const std::vector<std::string>& terms);  // AND search over the index
+    void saveIndex(const std::string& path);  // Write the index as a memory-mappable image
+    void loadIndex(const std::string& path);  // Replace the index with a saved image
+    void benchTokenizers(const std::string& path);  // Compare every tokenizer on the same files
+    void generateCorpus(const std::string& root, const std::vector<std::string>& settings);  // Write a synthetic dataset
+    void sweep(const std::string& path, const std::vector<std::string>& settings);  // Thread/affinity sweep to JSON
 
 private:
     // Member variables
     int numThreads;      // Number of threads to use
     int affinityFlag;    // Flag to determine if thread affinity is enabled
+    EngineOptions options;  // Optional settings from the command line
+
+    TokenizerKernelSet kernels;      // Tokenizer kernels chosen at runtime from the CPU features
+    NibbleTables nibbleTables;       // SIMD form of the charDict, rebuilt by initializeCharDict
+    IndexStore indexStore;           // Inverted index built from the tokenizer output
+    BlockSeekKernel blockSeekKernel; // In-block postings search chosen from the CPU features
+
+    // Number of loaded files each per-node ring can hold before loaders wait for workers
+    static constexpr size_t fileQueueCapacity = 1024;
+
+    // Buffer address, file offset and length alignment used for O_DIRECT reads
+    static constexpr size_t directIoAlignment = 4096;
+
+    // Number of results printed by the search command
+    static constexpr size_t searchResultCount = 10;
+
+    // Files a worker moves from its node ring into its own deque at a time
+    static constexpr int refillBatchSize = 4;
 
     // Private methods
     void loadFilesOnNode(int thread_id, 
                          int node_id, 
                          const std::vector<std::pair<std::string, uintmax_t>>& files, 
-                         std::queue<FileData>& fileBuffer, 
-                         std::mutex& bufferMutex);
+                         BoundedQueue<FileData>& fileBuffer,
+                         BufferPool& bufferPool,
+                         const char charDict[256],
+                         LoaderStats& stats);
+
+    void loadFilesMapped(int thread_id,
+                         int node_id,
+                         const std::vector<std::pair<std::string, uintmax_t>>& files,
+                         BoundedQueue<FileData>& fileBuffer,
+                         const char charDict[256],
+                         LoaderStats& stats);
+
+    void loadFilesSync(int thread_id,
+                       int node_id,
+                       const std::vector<std::pair<std::string, uintmax_t>>& files,
+                       BoundedQueue<FileData>& fileBuffer,
+                       BufferPool& bufferPool,
+                       const char charDict[256],
+                       LoaderStats& stats);
+
+    bool loadFilesUring(int thread_id,
+                        int node_id,
+                        const std::vector<std::pair<std::string, uintmax_t>>& files,
+                        BoundedQueue<FileData>& fileBuffer,
+                        BufferPool& bufferPool,
+                        const char charDict[256],
+                        LoaderStats& stats,
+                        std::vector<std::pair<std::string, uintmax_t>>& unloaded);
+
+    bool deferToConsumer(int node_id,
+                         const std::string& filePath,
+                         uintmax_t fileSize,
+                         BoundedQueue<FileData>& fileBuffer,
+                         BufferPool& bufferPool,
+                         LoaderStats& stats);
+
+    void publishFile(int node_id,
+                     const std::string& filePath,
+                     uintmax_t fileSize,
+                     char* buffer,
+                     size_t capacity,
+                     bool mapped,
+                     BoundedQueue<FileData>& fileBuffer,
+                     const char charDict[256],
+                     LoaderStats& stats);
 
     void processFile(int thread_id, 
-                     std::vector<std::queue<FileData>>& fileBuffersPerNode, 
-                     std::vector<std::mutex>& bufferMutexes, 
-                     std::mutex& tokenMutex, 
-                     std::mutex& bytesMutex, 
+                     std::vector<std::unique_ptr<BoundedQueue<FileData>>>& fileBuffersPerNode,
+                     BufferPool& bufferPool,
+                     std::vector<std::unique_ptr<WorkDeque<FileData>>>& workDeques,
                      char charDict[256], 
                      const std::string& path, 
                      const std::string& resultPath, 
-                     uintmax_t& totalBytes, 
-                     uintmax_t& totalTokens, 
-                     std::vector<double>& tokenizationTimes, 
-                     std::vector<uintmax_t>& bytesProcessed);
+                     std::vector<LocalTermTable>& localTables,
+                     StatsRegistry& statsRegistry,
+                     std::vector<PerfCounts>& perfCounts,
+                     std::vector<WorkerMetrics>& workerMetrics);
+
+    void reportProgress(const StatsRegistry& statsRegistry, uintmax_t totalBytes, std::mutex& doneMutex,
+                        std::condition_variable& doneSignal, const bool& done);
+    void writeMetrics(const RunMetrics& metrics);
+    void printLoadPhase(const LoaderStats& load, double seconds);
+    void reportPerfCounts(const std::vector<PerfCounts>& perfCounts, const StatsRegistry& statsRegistry);
+
+    bool findWork(int thread_id,
+                  int node,
+                  std::vector<std::unique_ptr<BoundedQueue<FileData>>>& fileBuffersPerNode,
+                  std::vector<std::unique_ptr<WorkDeque<FileData>>>& workDeques,
+                  FileData& fileData,
+                  uint64_t& localSteals,
+                  uint64_t& remoteSteals);
     
+    // NUMA placement helpers
+    int openInput(const std::string& filePath, bool& direct);
+    size_t bufferSizeFor(uintmax_t fileSize) const;
+    bool readFully(int fd, char* buffer, size_t size, bool& direct, size_t& readCalls);
+    void migratePages(char* data, size_t size, int node);
+    void measurePlacement(char* data, size_t size, int node, uintmax_t& localBytes, uintmax_t& remoteBytes);
+
     // Helper methods
-    std::vector<char*> tokenize(char* buffer, size_t fileSize, char charDict[256]);
+    void tokenize(char* buffer, size_t fileSize, char charDict[256], std::vector<char*>& tokens);
+    void tokenizeSpans(const char* buffer, size_t fileSize, char charDict[256], std::vector<TokenSpan>& spans);
+    void countTerms(const std::vector<char*>& tokens, const char* end, long documentNumber,
+                    LocalTermTable& localTable);
+    void countTerms(const std::vector<TokenSpan>& spans, long documentNumber, LocalTermTable& localTable);
+    void mergeIndex(std::vector<LocalTermTable>& localTables);
     void initializeCharDict(char charDict[256]);
-    std::vector<std::pair<std::string, uintmax_t>> crawlDataset(const std::string& path);
-    void crawl(const std::filesystem::path& folder, std::vector<std::pair<std::string, uintmax_t>>& fileInfos);
+    std::vector<CrawledFile> crawlDataset(const std::string& path);
     uintmax_t calculateDirectorySize(const std::filesystem::path& directory);
     void deleteDirectory(const std::filesystem::path& directory);
 };
@@ -0,0 +1,64 @@
+#ifndef STATSREGISTRY_HPP
+#define STATSREGISTRY_HPP
+
+#include <atomic>
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t
+#include <memory>
+
+// Counters every worker keeps while indexing
+enum WorkerStat {
+    StatFiles,              // Files (or chunks) processed
+    StatBytes,
+    StatTokens,
+    StatTokenizeNs,
+    StatIndexNs,            // Time spent counting terms into the local table
+    StatQueueWaitNs,        // Time spent finding work
+    StatLocalSteals,        // Files stolen from peers on the worker's node
+    StatRemoteSteals,       // Files stolen from other nodes
+    StatLocalMemoryBytes,   // Bytes tokenized from memory on the worker's node (--verify-placement)
+    StatRemoteMemoryBytes,  // Bytes tokenized from memory on other nodes
+    StatReadOperations,     // open/read/close calls for files the worker read itself (first-touch-by-consumer)
+    StatReadBytes,          // Bytes of those files
+    workerStatCount
+};
+
+// Plain counters: a worker's private running totals, or a snapshot read from the registry
+struct WorkerStats {
+    uint64_t values[workerStatCount] = {};
+
+    uint64_t& operator[](int stat) { return values[stat]; }
+    uint64_t operator[](int stat) const { return values[stat]; }
+    double seconds(int stat) const { return static_cast<double>(values[stat]) / 1e9; }
+    void add(const WorkerStats& other);
+};
+
+// Per-thread statistics without locks or false sharing. Every worker owns one slot,
+// padded to its own cache line, and publishes its private totals into it after each
+// file with relaxed stores; as the only writer it needs no read-modify-write. Any
+// other thread may snapshot a slot or the sum of all slots at any time, e.g. to print
+// progress, without slowing the workers down. A snapshot is exact once the workers
+// have been joined; while they run, each counter is a recent value of its own, not
+// necessarily from the same instant as the others.
+class StatsRegistry {
+public:
+    explicit StatsRegistry(size_t threads);
+
+    size_t size() const { return slotCount; }
+
+    // Store the running totals of a worker in its slot (called by that worker only)
+    void publish(size_t thread, const WorkerStats& stats);
+
+    WorkerStats snapshot(size_t thread) const;
+    WorkerStats total() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> values[workerStatCount];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount;
+};
+
+#endif // STATSREGISTRY_HPP
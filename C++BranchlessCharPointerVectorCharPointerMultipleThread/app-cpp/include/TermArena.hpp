@@ -0,0 +1,46 @@
+#ifndef TERMARENA_HPP
+#define TERMARENA_HPP
+
+#include <cstddef>       // For size_t
+#include <memory>
+#include <vector>
+
+// Bump allocator for term bytes.
+//
+// Terms are copied in back to back into large blocks and are never freed one by one;
+// the whole arena goes away with its owner. One arena is owned by a single thread (a
+// worker's local table, or the index partition being merged), so it needs no lock.
+// Stored terms are not null terminated: the dictionary keeps their length.
+class TermArena {
+public:
+    TermArena() = default;
+
+    TermArena(const TermArena&) = delete;
+    TermArena& operator=(const TermArena&) = delete;
+    TermArena(TermArena&&) = default;
+    TermArena& operator=(TermArena&&) = default;
+
+    // Copy length bytes of term into the arena and return the stable copy
+    const char* store(const char* term, size_t length);
+
+    // Drop every stored term
+    void clear();
+
+    size_t bytesUsed() const { return usedBytes; }
+    size_t bytesReserved() const { return reservedBytes; }
+
+private:
+    // Blocks start small and double up to the maximum, so the many small arenas of a
+    // partitioned index waste little while large ones allocate rarely
+    static constexpr size_t firstBlockSize = 4 * 1024;
+    static constexpr size_t maxBlockSize = 1024 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor = nullptr;     // Next free byte of the current block
+    size_t remaining = 0;       // Free bytes left in the current block
+    size_t nextBlockSize = firstBlockSize;
+    size_t usedBytes = 0;       // Term bytes stored
+    size_t reservedBytes = 0;   // Bytes allocated for blocks
+};
+
+#endif // TERMARENA_HPP
@@ -0,0 +1,209 @@
+#ifndef TERMDICTIONARY_HPP
+#define TERMDICTIONARY_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t
+#include <cstring>       // For memcmp, memcpy
+#include <emmintrin.h>   // SSE2 group probing
+#include <utility>       // For std::move
+#include <vector>
+
+#include "TermArena.hpp"
+
+// 64-bit hash of a term, computed once per token and stored with the term so tables
+// never rehash keys when they grow or when terms move between tables
+inline uint64_t hashTerm(const char* term, size_t length) {
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+    uint64_t hash = length * multiplier;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, term, 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+        term += 8;
+        length -= 8;
+    }
+    if (length > 0) {
+        uint64_t word = 0;
+        memcpy(&word, term, length);
+        hash = (hash ^ word) * multiplier;
+    }
+    // Final avalanche (MurmurHash3 fmix64) so every bit of the hash is usable
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Open-addressing term -> Value table in the style of SwissTable.
+//
+// Every slot has a control byte: 0x80 when empty, otherwise the low 7 bits of the
+// term's hash. Slots are probed 16 at a time: one SSE2 compare of a group of control
+// bytes against the 7-bit tag finds the candidate slots, and only those compare term
+// bytes. Groups are visited in triangular order, which covers every group because the
+// group count is a power of two. Term bytes live in a TermArena supplied by the owner,
+// so the table itself never allocates per term. There is no single-entry erase (it would
+// need tombstones on every probe); eraseIf removes entries in bulk by rebuilding.
+template <typename Value>
+class TermDictionary {
+public:
+    struct Slot {
+        const char* term;   // Term bytes in the owner's arena
+        uint32_t length;
+        uint64_t hash;      // Precomputed hashTerm() of the term
+        Value value;
+    };
+
+    TermDictionary() = default;
+
+    // Entry for a term, inserting a default Value (and copying the term into arena) if absent
+    Value& findOrInsert(const char* term, size_t length, uint64_t hash, TermArena& arena) {
+        if (capacity == 0 || (count + 1) * 8 > capacity * 7) {
+            grow();
+        }
+        size_t index;
+        if (lookup(term, length, hash, index)) {
+            return slots[index].value;
+        }
+        // index is the first empty slot on the probe sequence
+        control[index] = tag(hash);
+        Slot& slot = slots[index];
+        slot.term = arena.store(term, length);
+        slot.length = static_cast<uint32_t>(length);
+        slot.hash = hash;
+        count++;
+        return slot.value;
+    }
+
+    // Entry for a term, or nullptr if absent
+    Value* find(const char* term, size_t length, uint64_t hash) {
+        size_t index;
+        if (capacity == 0 || !lookup(term, length, hash, index)) {
+            return nullptr;
+        }
+        return &slots[index].value;
+    }
+
+    // Call function(const Slot&, Value&) for every entry
+    template <typename Function>
+    void forEach(Function function) {
+        for (size_t i = 0; i < capacity; ++i) {
+            if (control[i] != emptyControl) {
+                function(static_cast<const Slot&>(slots[i]), slots[i].value);
+            }
+        }
+    }
+
+    // Remove every entry for which predicate(const Slot&, Value&) is true and return how
+    // many were removed. The remaining entries are reinserted into fresh arrays of the same
+    // capacity, so probe sequences stay intact. Term bytes stay in the owner's arena.
+    template <typename Predicate>
+    size_t eraseIf(Predicate predicate) {
+        std::vector<Slot> oldSlots(capacity);
+        std::vector<int8_t> oldControl(capacity, emptyControl);
+        oldSlots.swap(slots);
+        oldControl.swap(control);
+        size_t oldCount = count;
+
+        count = 0;
+        for (size_t i = 0; i < capacity; ++i) {
+            if (oldControl[i] != emptyControl && !predicate(static_cast<const Slot&>(oldSlots[i]), oldSlots[i].value)) {
+                size_t index = firstEmpty(oldSlots[i].hash);
+                control[index] = tag(oldSlots[i].hash);
+                slots[index] = std::move(oldSlots[i]);
+                count++;
+            }
+        }
+        return oldCount - count;
+    }
+
+    void clear() {
+        std::vector<Slot>().swap(slots);
+        std::vector<int8_t>().swap(control);
+        capacity = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+
+    // Bytes held by the slot and control arrays (terms are counted by their arena)
+    size_t memoryBytes() const { return capacity * (sizeof(Slot) + 1); }
+
+private:
+    static constexpr size_t groupWidth = 16;
+    static constexpr int8_t emptyControl = static_cast<int8_t>(0x80);
+
+    static int8_t tag(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    // Find term; on a miss index is set to the first empty slot of its probe sequence
+    bool lookup(const char* term, size_t length, uint64_t hash, size_t& index) const {
+        const size_t groupMask = capacity / groupWidth - 1;
+        const __m128i tagVector = _mm_set1_epi8(tag(hash));
+        const __m128i emptyVector = _mm_set1_epi8(emptyControl);
+        size_t group = (hash >> 7) & groupMask;
+        for (size_t step = 1;; ++step) {
+            const int8_t* groupControl = control.data() + group * groupWidth;
+            __m128i controlBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(groupControl));
+
+            unsigned matches = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(controlBytes, tagVector)));
+            while (matches != 0) {
+                size_t candidate = group * groupWidth + __builtin_ctz(matches);
+                const Slot& slot = slots[candidate];
+                if (slot.hash == hash && slot.length == length && memcmp(slot.term, term, length) == 0) {
+                    index = candidate;
+                    return true;
+                }
+                matches &= matches - 1;
+            }
+
+            unsigned empties = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(controlBytes, emptyVector)));
+            if (empties != 0) {
+                index = group * groupWidth + __builtin_ctz(empties);
+                return false;
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // First empty slot on the probe sequence of hash (the table is never full)
+    size_t firstEmpty(uint64_t hash) const {
+        const size_t groupMask = capacity / groupWidth - 1;
+        const __m128i emptyVector = _mm_set1_epi8(emptyControl);
+        size_t group = (hash >> 7) & groupMask;
+        for (size_t step = 1;; ++step) {
+            __m128i controlBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control.data() + group * groupWidth));
+            unsigned empties = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(controlBytes, emptyVector)));
+            if (empties != 0) {
+                return group * groupWidth + __builtin_ctz(empties);
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // Double the capacity and reinsert every entry using its stored hash
+    void grow() {
+        size_t oldCapacity = capacity;
+        std::vector<Slot> oldSlots(capacity == 0 ? groupWidth : capacity * 2);
+        std::vector<int8_t> oldControl(oldSlots.size(), emptyControl);
+        oldSlots.swap(slots);
+        oldControl.swap(control);
+        capacity = slots.size();
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (oldControl[i] != emptyControl) {
+                size_t index = firstEmpty(oldSlots[i].hash);
+                control[index] = tag(oldSlots[i].hash);
+                slots[index] = std::move(oldSlots[i]);
+            }
+        }
+    }
+
+    std::vector<Slot> slots;
+    std::vector<int8_t> control;
+    size_t capacity = 0;   // Slot count, a power of two and a multiple of groupWidth
+    size_t count = 0;      // Entries stored
+};
+
+#endif // TERMDICTIONARY_HPP
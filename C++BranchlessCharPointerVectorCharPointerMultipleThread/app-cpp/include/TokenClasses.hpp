@@ -0,0 +1,116 @@
+#ifndef TOKENCLASSES_HPP
+#define TOKENCLASSES_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "TokenizerKernels.hpp"
+
+// A charDict as a value: ~0 for token characters, 0 for delimiters
+using CharTable = std::array<char, 256>;
+
+// ASCII letters and digits. Unlike isalnum this does not depend on the C locale, so
+// bytes above 0x7F (Latin-1, UTF-8 sequences) are always delimiters.
+constexpr bool isAsciiAlnum(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+// Token character classes selectable with --token-chars. The tokenizer kernels take the
+// class as a template parameter: a fixed class has a constexpr isTokenChar the compiler
+// inlines into the scalar loops, and its charDict and nibble tables are computed at
+// compile time, so its kernels never read the charDict or NibbleTables passed to them.
+// RuntimeTokenChars (custom:CHARS) is the one class that does.
+struct AlnumTokenChars {
+    static constexpr bool fixed = true;
+    static constexpr bool isTokenChar(unsigned char c) { return isAsciiAlnum(c); }
+};
+
+// Identifiers: snake_case stays one token
+struct AlnumUnderscoreTokenChars {
+    static constexpr bool fixed = true;
+    static constexpr bool isTokenChar(unsigned char c) { return isAsciiAlnum(c) || c == '_'; }
+};
+
+// Prose: contractions and possessives ("don't", "engine's") stay one token
+struct AlnumApostropheTokenChars {
+    static constexpr bool fixed = true;
+    static constexpr bool isTokenChar(unsigned char c) { return isAsciiAlnum(c) || c == '\''; }
+};
+
+// Letters and digits plus the characters given on the command line, looked up in the
+// charDict at run time
+struct RuntimeTokenChars {
+    static constexpr bool fixed = false;
+};
+
+template <typename Chars>
+constexpr CharTable makeCharTable() {
+    CharTable table = {};
+    for (int c = 0; c < 256; ++c) {
+        table[c] = Chars::isTokenChar(static_cast<unsigned char>(c)) ? ~0 : 0;
+    }
+    return table;
+}
+
+// Compile-time charDict and nibble tables of a fixed class
+template <typename Chars>
+struct TokenCharTables {
+    static constexpr CharTable table = makeCharTable<Chars>();
+    static constexpr NibbleTables nibbles = buildNibbleTables(table.data());
+};
+
+// Classification of byte c as the kernels use it: ~0 for a token character, 0 for a
+// delimiter. A constant expression for the fixed classes.
+template <typename Chars>
+inline char classifyChar(const char charDict[256], unsigned char c) {
+    if constexpr (Chars::fixed) {
+        return Chars::isTokenChar(c) ? ~0 : 0;
+    } else {
+        return charDict[c];
+    }
+}
+
+// Nibble tables the SIMD kernels shuffle with: the compile-time ones of a fixed class
+template <typename Chars>
+inline const NibbleTables& classNibbleTables(const NibbleTables& tables) {
+    if constexpr (Chars::fixed) {
+        return TokenCharTables<Chars>::nibbles;
+    } else {
+        return tables;
+    }
+}
+
+// Names of the fixed classes accepted by --token-chars (besides custom:CHARS)
+const std::vector<std::string>& tokenCharClassNames();
+
+// True if tokenChars names a fixed class or is custom:CHARS
+bool isTokenCharClass(const std::string& tokenChars);
+
+// Fill charDict for tokenChars; returns false (leaving the alnum class) if the name is
+// not a token character class
+bool buildCharTable(const std::string& tokenChars, char charDict[256]);
+
+// Empty value standing for a class type, so a generic lambda can receive one
+template <typename Chars>
+struct TokenCharsTag {
+    using type = Chars;
+};
+
+// Call visit(TokenCharsTag<Chars>()) with the class named by tokenChars; custom:CHARS
+// (and anything else) is the runtime class
+template <typename Visitor>
+auto visitTokenChars(const std::string& tokenChars, Visitor visit) {
+    if (tokenChars == "alnum") {
+        return visit(TokenCharsTag<AlnumTokenChars>());
+    }
+    if (tokenChars == "alnum-underscore") {
+        return visit(TokenCharsTag<AlnumUnderscoreTokenChars>());
+    }
+    if (tokenChars == "alnum-apostrophe") {
+        return visit(TokenCharsTag<AlnumApostropheTokenChars>());
+    }
+    return visit(TokenCharsTag<RuntimeTokenChars>());
+}
+
+#endif // TOKENCLASSES_HPP
@@ -0,0 +1,97 @@
+#ifndef TOKENIZERKERNELS_HPP
+#define TOKENIZERKERNELS_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint8_t
+#include <string>
+#include <vector>
+
+// Nibble lookup tables equivalent to a 256-entry charDict: a byte c is a token
+// character exactly when (low[c & 0xF] & high[c >> 4]) != 0. This lets SIMD kernels
+// classify a whole vector with two byte shuffles instead of one table load per byte.
+struct NibbleTables {
+    uint8_t low[16];
+    uint8_t high[16];
+    bool valid;      // False if the charDict needs more than 8 distinct row patterns
+};
+
+// A token inside a read-only buffer
+struct TokenSpan {
+    const char* start;
+    size_t length;
+};
+
+// Kernel signature shared by the scalar and vectorized implementations. Every kernel
+// masks delimiters to '\0' in place and appends a pointer to the start of each token.
+// (TokenizerSinks.hpp has the same kernels as templates over a caller-supplied sink.)
+using TokenizeKernel = void (*)(char* buffer, size_t size, const char charDict[256],
+                                const NibbleTables& tables, std::vector<char*>& tokens);
+
+// Read-only variant: the buffer is never written, tokens are reported as spans
+using TokenizeSpansKernel = void (*)(const char* buffer, size_t size, const char charDict[256],
+                                     const NibbleTables& tables, std::vector<TokenSpan>& spans);
+
+// Counting variant: scans a read-only buffer and returns the number of tokens without
+// storing any of them
+using CountTokensKernel = size_t (*)(const char* buffer, size_t size, const char charDict[256],
+                                     const NibbleTables& tables);
+
+// Kernels of one instruction set
+struct TokenizerKernelSet {
+    TokenizeKernel tokenize;
+    TokenizeSpansKernel tokenizeSpans;
+    CountTokensKernel countTokens;
+    std::string name;
+};
+
+// Build the nibble tables for a charDict (token characters are ~0, delimiters 0) by
+// giving every distinct row pattern (the set of low nibbles that are token characters
+// for one high nibble) its own bit. constexpr, so the tables of the built-in token
+// character classes are computed by the compiler (see TokenClasses.hpp).
+constexpr NibbleTables buildNibbleTables(const char charDict[256]) {
+    NibbleTables tables = {};
+    tables.valid = true;
+
+    uint16_t rowPatterns[8] = {};
+    int patternCount = 0;
+
+    for (int high = 0; high < 16; ++high) {
+        uint16_t row = 0;
+        for (int low = 0; low < 16; ++low) {
+            if (charDict[(high << 4) | low] != 0) {
+                row |= uint16_t(1) << low;
+            }
+        }
+        if (row == 0) {
+            continue;  // No token characters with this high nibble
+        }
+
+        int bit = 0;
+        while (bit < patternCount && rowPatterns[bit] != row) {
+            ++bit;
+        }
+        if (bit == patternCount) {
+            if (patternCount == 8) {
+                tables.valid = false;  // Not representable with 8-bit shuffle tables
+                return tables;
+            }
+            rowPatterns[patternCount++] = row;
+        }
+
+        tables.high[high] = uint8_t(1) << bit;
+        for (int low = 0; low < 16; ++low) {
+            if (row & (uint16_t(1) << low)) {
+                tables.low[low] |= uint8_t(1) << bit;
+            }
+        }
+    }
+    return tables;
+}
+
+// Pick kernels by name ("auto", "scalar", "avx2", "avx512"). "auto" uses cpuid to
+// choose the widest kernels this CPU supports; an explicit request the CPU cannot run
+// falls back to the next narrower kernels. The kernels are specialized for the token
+// character class tokenChars (see TokenClasses.hpp).
+TokenizerKernelSet selectTokenizerKernels(const std::string& requested, const std::string& tokenChars);
+
+#endif // TOKENIZERKERNELS_HPP
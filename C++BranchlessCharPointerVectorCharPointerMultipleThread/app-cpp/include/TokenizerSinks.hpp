@@ -0,0 +1,300 @@
+#ifndef TOKENIZERSINKS_HPP
+#define TOKENIZERSINKS_HPP
+
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t
+#include <vector>
+#include <immintrin.h>   // AVX2 / AVX-512 intrinsics
+
+#include "TokenClasses.hpp"
+#include "TokenizerKernels.hpp"
+
+// Templated tokenizer kernels that hand every token to a caller-supplied sink instead of
+// a vector they own, so the caller decides what a token costs. A sink is any type with
+//   static constexpr bool countsOnly;      true if only the number of tokens matters
+//   void token(char* start);               in-place kernels: start of a masked token
+//   void span(const char* start, size_t length);   read-only kernels: one token
+//   void addCount(size_t tokens);          countsOnly sinks: tokens of a whole block
+// (only the members the kernels it is used with call). The sink is a template argument,
+// so its members inline into the loop: with a countsOnly sink the SIMD kernels just
+// popcount the token starts of each block and the scan does no stores at all.
+//
+// The token character class is the first template argument (see TokenClasses.hpp): for a
+// fixed class the scalar loops test a constexpr predicate and the SIMD loops shuffle
+// with compile-time tables. The function-pointer kernels of TokenizerKernelSet are these
+// templates instantiated with each class and the sinks below.
+
+// Appends token starts to a vector the caller owns and reuses (clear() keeps capacity)
+struct TokenAppender {
+    static constexpr bool countsOnly = false;
+    std::vector<char*>& tokens;
+
+    void token(char* start) { tokens.push_back(start); }
+};
+
+// Appends token spans to a vector the caller owns and reuses
+struct SpanAppender {
+    static constexpr bool countsOnly = false;
+    std::vector<TokenSpan>& spans;
+
+    void span(const char* start, size_t length) { spans.push_back({start, length}); }
+};
+
+// Counts tokens without storing them
+struct TokenCounter {
+    static constexpr bool countsOnly = true;
+    size_t count = 0;
+
+    void token(char*) { ++count; }
+    void span(const char*, size_t) { ++count; }
+    void addCount(size_t tokens) { count += tokens; }
+};
+
+// In-place scalar loop starting at position start with the classification of the
+// previous byte
+template <typename Chars, typename Sink>
+inline void tokenizeScalarFrom(char* buffer, size_t start, size_t size, const char charDict[256],
+                               char charPrev, Sink& sink) {
+    for (size_t i = start; i < size; i++) {
+        char charNext = classifyChar<Chars>(charDict, (unsigned char)buffer[i]);
+        buffer[i] = buffer[i] & charNext;
+
+        if (charPrev == 0 && charNext == ~0) {
+            sink.token(&buffer[i]);
+        }
+
+        charPrev = charNext;
+    }
+}
+
+// Report every set bit of a token-start bitmask
+template <typename Sink>
+inline void emitTokenStarts(char* base, uint64_t starts, Sink& sink) {
+    if constexpr (Sink::countsOnly) {
+        sink.addCount(static_cast<size_t>(__builtin_popcountll(starts)));
+    } else {
+        while (starts != 0) {
+            sink.token(base + __builtin_ctzll(starts));
+            starts &= starts - 1;
+        }
+    }
+}
+
+template <typename Chars, typename Sink>
+void tokenizeScalarInto(char* buffer, size_t size, const char charDict[256],
+                        const NibbleTables& tables, Sink& sink) {
+    (void)tables;
+    tokenizeScalarFrom<Chars>(buffer, 0, size, charDict, 0, sink);
+}
+
+// 32 bytes per iteration: classify with two shuffles, zero the delimiters in place and
+// derive token starts as token bytes whose previous byte is a delimiter
+template <typename Chars, typename Sink>
+__attribute__((target("avx2")))
+void tokenizeAvx2Into(char* buffer, size_t size, const char charDict[256],
+                      const NibbleTables& runtimeTables, Sink& sink) {
+    const NibbleTables& tables = classNibbleTables<Chars>(runtimeTables);
+    if (!tables.valid) {
+        tokenizeScalarFrom<Chars>(buffer, 0, size, charDict, 0, sink);
+        return;
+    }
+
+    const __m256i lowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.low)));
+    const __m256i highTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.high)));
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+
+    uint64_t carry = 0;  // 1 if the last byte of the previous block was a token character
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i));
+        __m256i lowNibbles = _mm256_and_si256(bytes, nibbleMask);
+        __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibbleMask);
+        __m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(lowTable, lowNibbles),
+                                           _mm256_shuffle_epi8(highTable, highNibbles));
+        __m256i isDelimiter = _mm256_cmpeq_epi8(classes, zero);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + i), _mm256_andnot_si256(isDelimiter, bytes));
+
+        uint64_t tokenBits = ~static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(isDelimiter))) & 0xFFFFFFFFull;
+        uint64_t starts = tokenBits & ~((tokenBits << 1) | carry);
+        emitTokenStarts(buffer + i, starts, sink);
+        carry = tokenBits >> 31;
+    }
+
+    tokenizeScalarFrom<Chars>(buffer, i, size, charDict, carry ? ~0 : 0, sink);
+}
+
+// 64 bytes per iteration using AVX-512BW mask registers
+template <typename Chars, typename Sink>
+__attribute__((target("avx512f,avx512bw")))
+void tokenizeAvx512Into(char* buffer, size_t size, const char charDict[256],
+                        const NibbleTables& runtimeTables, Sink& sink) {
+    const NibbleTables& tables = classNibbleTables<Chars>(runtimeTables);
+    if (!tables.valid) {
+        tokenizeScalarFrom<Chars>(buffer, 0, size, charDict, 0, sink);
+        return;
+    }
+
+    const __m512i lowTable = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.low)));
+    const __m512i highTable = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.high)));
+    const __m512i nibbleMask = _mm512_set1_epi8(0x0F);
+
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i bytes = _mm512_loadu_si512(buffer + i);
+        __m512i lowNibbles = _mm512_and_si512(bytes, nibbleMask);
+        __m512i highNibbles = _mm512_and_si512(_mm512_srli_epi16(bytes, 4), nibbleMask);
+        __m512i classes = _mm512_and_si512(_mm512_shuffle_epi8(lowTable, lowNibbles),
+                                           _mm512_shuffle_epi8(highTable, highNibbles));
+        __mmask64 tokenBits = _mm512_test_epi8_mask(classes, classes);
+
+        _mm512_storeu_si512(buffer + i, _mm512_maskz_mov_epi8(tokenBits, bytes));
+
+        uint64_t starts = tokenBits & ~((static_cast<uint64_t>(tokenBits) << 1) | carry);
+        emitTokenStarts(buffer + i, starts, sink);
+        carry = static_cast<uint64_t>(tokenBits) >> 63;
+    }
+
+    tokenizeScalarFrom<Chars>(buffer, i, size, charDict, carry ? ~0 : 0, sink);
+}
+
+// Read-only scalar loop starting at position start; open is the start of a token that
+// began before it (nullptr if the previous byte was a delimiter). Counting sinks count
+// tokens where they start, like the SIMD blocks before this tail do.
+template <typename Chars, typename Sink>
+inline void tokenizeSpansScalarFrom(const char* buffer, size_t start, size_t size, const char charDict[256],
+                                    const char* open, Sink& sink) {
+    bool inToken = open != nullptr;
+    for (size_t i = start; i < size; i++) {
+        bool isToken = classifyChar<Chars>(charDict, (unsigned char)buffer[i]) != 0;
+        if constexpr (Sink::countsOnly) {
+            sink.addCount(isToken && !inToken);
+        } else if (isToken && !inToken) {
+            open = buffer + i;
+        } else if (!isToken && inToken) {
+            sink.span(open, static_cast<size_t>(buffer + i - open));
+        }
+        inToken = isToken;
+    }
+    if constexpr (!Sink::countsOnly) {
+        if (inToken) {
+            sink.span(open, static_cast<size_t>(buffer + size - open));
+        }
+    }
+}
+
+// Report the tokens of one block from its token bitmask. Starts are token bytes after a
+// delimiter, ends are delimiters after a token byte, and they alternate: the first end
+// closes the token left open by an earlier block, every later one the start before it.
+// A start without an end runs past the block and is left open.
+template <typename Sink>
+inline void emitSpans(const char* base, uint64_t tokenBits, uint64_t carry, unsigned blockBits,
+                      const char*& open, Sink& sink) {
+    uint64_t blockMask = blockBits == 64 ? ~0ull : ((1ull << blockBits) - 1);
+    uint64_t previous = ((tokenBits << 1) | carry) & blockMask;
+    uint64_t starts = tokenBits & ~previous;
+    if constexpr (Sink::countsOnly) {
+        sink.addCount(static_cast<size_t>(__builtin_popcountll(starts)));
+    } else {
+        uint64_t ends = ~tokenBits & previous & blockMask;
+        if (open != nullptr && ends != 0) {
+            sink.span(open, static_cast<size_t>(base + __builtin_ctzll(ends) - open));
+            open = nullptr;
+            ends &= ends - 1;
+        }
+        while (starts != 0) {
+            const char* start = base + __builtin_ctzll(starts);
+            starts &= starts - 1;
+            if (ends == 0) {
+                open = start;
+                break;
+            }
+            sink.span(start, static_cast<size_t>(base + __builtin_ctzll(ends) - start));
+            ends &= ends - 1;
+        }
+    }
+}
+
+template <typename Chars, typename Sink>
+void tokenizeSpansScalarInto(const char* buffer, size_t size, const char charDict[256],
+                             const NibbleTables& tables, Sink& sink) {
+    (void)tables;
+    tokenizeSpansScalarFrom<Chars>(buffer, 0, size, charDict, nullptr, sink);
+}
+
+template <typename Chars, typename Sink>
+__attribute__((target("avx2")))
+void tokenizeSpansAvx2Into(const char* buffer, size_t size, const char charDict[256],
+                           const NibbleTables& runtimeTables, Sink& sink) {
+    const NibbleTables& tables = classNibbleTables<Chars>(runtimeTables);
+    if (!tables.valid) {
+        tokenizeSpansScalarFrom<Chars>(buffer, 0, size, charDict, nullptr, sink);
+        return;
+    }
+
+    const __m256i lowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.low)));
+    const __m256i highTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.high)));
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+
+    const char* open = nullptr;  // Start of the token still missing its end
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i));
+        __m256i lowNibbles = _mm256_and_si256(bytes, nibbleMask);
+        __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibbleMask);
+        __m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(lowTable, lowNibbles),
+                                           _mm256_shuffle_epi8(highTable, highNibbles));
+        __m256i isDelimiter = _mm256_cmpeq_epi8(classes, zero);
+
+        uint64_t tokenBits = ~static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(isDelimiter))) & 0xFFFFFFFFull;
+        emitSpans(buffer + i, tokenBits, carry, 32, open, sink);
+        carry = tokenBits >> 31;
+    }
+
+    // Counting sinks never track open tokens; the tail only needs to know it is in one
+    if constexpr (Sink::countsOnly) {
+        open = carry ? buffer + i : nullptr;
+    }
+    tokenizeSpansScalarFrom<Chars>(buffer, i, size, charDict, open, sink);
+}
+
+template <typename Chars, typename Sink>
+__attribute__((target("avx512f,avx512bw")))
+void tokenizeSpansAvx512Into(const char* buffer, size_t size, const char charDict[256],
+                             const NibbleTables& runtimeTables, Sink& sink) {
+    const NibbleTables& tables = classNibbleTables<Chars>(runtimeTables);
+    if (!tables.valid) {
+        tokenizeSpansScalarFrom<Chars>(buffer, 0, size, charDict, nullptr, sink);
+        return;
+    }
+
+    const __m512i lowTable = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.low)));
+    const __m512i highTable = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.high)));
+    const __m512i nibbleMask = _mm512_set1_epi8(0x0F);
+
+    const char* open = nullptr;
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i bytes = _mm512_loadu_si512(buffer + i);
+        __m512i lowNibbles = _mm512_and_si512(bytes, nibbleMask);
+        __m512i highNibbles = _mm512_and_si512(_mm512_srli_epi16(bytes, 4), nibbleMask);
+        __m512i classes = _mm512_and_si512(_mm512_shuffle_epi8(lowTable, lowNibbles),
+                                           _mm512_shuffle_epi8(highTable, highNibbles));
+        uint64_t tokenBits = _mm512_test_epi8_mask(classes, classes);
+
+        emitSpans(buffer + i, tokenBits, carry, 64, open, sink);
+        carry = tokenBits >> 63;
+    }
+
+    if constexpr (Sink::countsOnly) {
+        open = carry ? buffer + i : nullptr;
+    }
+    tokenizeSpansScalarFrom<Chars>(buffer, i, size, charDict, open, sink);
+}
+
+#endif // TOKENIZERSINKS_HPP
@@ -0,0 +1,39 @@
+#ifndef TOKENIZERSTRATEGIES_HPP
+#define TOKENIZERSTRATEGIES_HPP
+
+#include <cstddef>       // For size_t
+#include <string>
+#include <vector>
+
+#include "TokenizerKernels.hpp"
+
+// Tokenizer strategies selectable with --tokenizer. They differ only in how a buffer is
+// split; for the same charDict every strategy reports the same tokens, so the index does
+// not depend on the choice:
+//   branchless  the charDict kernels (scalar, AVX2 or AVX-512, chosen by --simd)
+//   strtok      the strtok_r algorithm: skip a run of delimiters, scan to the next one and
+//               end the token there with '\0'. Bounded by the buffer size, because buffers
+//               (and chunks in particular) are not null-terminated.
+//   regex       std::regex matching runs of token characters
+//
+// All of them have the TokenizeKernel / TokenizeSpansKernel / CountTokensKernel
+// signatures, so a strategy is just another TokenizerKernelSet. The branchless and
+// strtok kernels are specialized per token character class (see TokenClasses.hpp); the
+// regex is built from the charDict, which holds the same class.
+
+void tokenizeRegex(char* buffer, size_t size, const char charDict[256],
+                   const NibbleTables& tables, std::vector<char*>& tokens);
+void tokenizeSpansRegex(const char* buffer, size_t size, const char charDict[256],
+                        const NibbleTables& tables, std::vector<TokenSpan>& spans);
+
+size_t countTokensRegex(const char* buffer, size_t size, const char charDict[256], const NibbleTables& tables);
+
+// Names accepted by --tokenizer
+const std::vector<std::string>& tokenizerStrategyNames();
+
+// Kernels of a strategy for the token character class tokenChars; simd picks the kernel
+// of the branchless strategy (see selectTokenizerKernels) and is ignored by the others
+TokenizerKernelSet selectTokenizer(const std::string& strategy, const std::string& simd,
+                                   const std::string& tokenChars);
+
+#endif // TOKENIZERSTRATEGIES_HPP
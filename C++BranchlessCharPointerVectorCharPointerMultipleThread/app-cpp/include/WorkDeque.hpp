@@ -0,0 +1,53 @@
+#ifndef WORKDEQUE_HPP
+#define WORKDEQUE_HPP
+
+#include <deque>
+#include <mutex>
+#include <utility>       // For std::move
+#include <vector>
+
+// Per-worker deque of pending work. The owner appends to the back and takes the oldest
+// item from the front; thieves take the newer half from the back, so an owner and a
+// thief rarely touch the same end. The lock is only contended while a steal is in progress.
+template <typename T>
+class WorkDeque {
+public:
+    // Owner: add an item
+    void push(T item) {
+        std::lock_guard<std::mutex> lock(dequeMutex);
+        items.push_back(std::move(item));
+    }
+
+    // Owner: take the next item, returns false if the deque is empty
+    bool pop(T& item) {
+        std::lock_guard<std::mutex> lock(dequeMutex);
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    // Thief: move up to half of the items (at least one) into stolen, returns the count
+    size_t stealHalf(std::vector<T>& stolen) {
+        std::lock_guard<std::mutex> lock(dequeMutex);
+        size_t count = (items.size() + 1) / 2;
+        for (size_t i = 0; i < count; ++i) {
+            stolen.push_back(std::move(items.back()));
+            items.pop_back();
+        }
+        return count;
+    }
+
+    bool empty() {
+        std::lock_guard<std::mutex> lock(dequeMutex);
+        return items.empty();
+    }
+
+private:
+    std::mutex dequeMutex;
+    std::deque<T> items;
+};
+
+#endif // WORKDEQUE_HPP
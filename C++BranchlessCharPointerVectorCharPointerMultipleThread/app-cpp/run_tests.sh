@@ -1,57 +1,44 @@
 #!/bin/bash
 
-# Define the array of thread counts you want to test
-thread_counts=(1 2 4 8 16 32 48 64 96)
-# thread_counts=(32 64 96)
+# Scaling benchmark: index a dataset with every thread count and affinity setting and
+# write the results as JSON. Needs no root: the engine evicts the dataset from the page
+# cache itself before every run (cold=1).
+#
+# Usage: ./run_tests.sh [dataset directory] [output file]
+# Without a dataset directory a synthetic corpus is generated in ./synthetic-dataset.
 
-# Define the number of iterations you want to run for each thread count
-iterations=1
+# Dataset to index (generated if it does not exist yet)
+dataset=${1:-synthetic-dataset}
 
 # Define the output file for storing results
-output_file="AffinityGutenberg.txt"
-
-# Create or clear the output file
-echo "Test Results - $(date)" > "$output_file"
-echo "---------------------------------------" >> "$output_file"
-
-# Loop over each thread count
-for threads in "${thread_counts[@]}"
-do
-    echo "Testing with $threads threads..." | tee -a "$output_file"
-    
-    # Loop to run the test multiple times for each thread count
-    for ((i=1; i<=iterations; i++))
-    do
-        # Set the affinityFlag (1 to enable, 0 to disable)
-        affinityFlag=1  # Change to 1 to enable thread affinity
-        
-        # Display running iteration with affinity information
-        echo "Running iteration $i for $threads threads... (affinity = $affinityFlag)" | tee -a "$output_file"
-        
-        # Run the program with the current thread count and affinityFlag, provide input, and capture the output
-        ./build/file-retrieval-engine "$threads" "$affinityFlag" <<EOF | tee temp_output.txt
-index /home/cc/dataset3_client_server
-quit
-EOF
+output_file=${2:-results.json}
 
-        # Ensure the program has fully terminated before moving on
-        wait
+# Define the thread counts and affinity settings you want to test
+thread_counts="1,2,4,8,16,32,48,64,96"
+affinity_flags="0,1"
 
-        # Add commands to clear caches after the program exits
-        sudo sync
-        sudo sh -c "echo 3 > /proc/sys/vm/drop_caches"
+# Define the number of iterations you want to run for each configuration
+iterations=3
 
-        # Append the output of the command to the output file
-        echo "Result for $threads threads, iteration $i:" >> "$output_file"
-        cat temp_output.txt >> "$output_file"
-        echo "---------------------------------------" >> "$output_file"
+# Shape of the synthetic corpus: files, mean size, size distribution, word skew, tree shape
+corpus_settings="files=2000 mean-kb=64 size-dist=lognormal vocabulary=50000 zipf=1.0 depth=2 fanout=8 seed=42"
 
-        # Add a short delay between iterations to ensure everything resets properly
-        sleep 2
-    done
-done
+# Skip thread counts this machine does not have
+cpus=$(nproc)
+thread_counts=$(echo "$thread_counts" | tr ',' '\n' | awk -v cpus="$cpus" '$1 <= cpus' | paste -sd, -)
 
-# Clean up temporary files
-rm temp_output.txt
+if [ ! -d "$dataset" ]; then
+    echo "Generating synthetic dataset in $dataset ($corpus_settings)"
+    ./build/file-retrieval-engine "$cpus" 0 <<EOF
+generate $dataset $corpus_settings
+quit
+EOF
+fi
+
+echo "Testing with threads $thread_counts, affinity $affinity_flags, $iterations iterations each"
+./build/file-retrieval-engine 1 0 <<EOF
+sweep $dataset threads=$thread_counts affinity=$affinity_flags repeat=$iterations cold=1 output=$output_file
+quit
+EOF
 
 echo "Testing complete. Results stored in $output_file"
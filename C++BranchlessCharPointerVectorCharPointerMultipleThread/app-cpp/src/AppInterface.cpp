@@ -49,20 +49,56 @@ void AppInterface::readCommands() {
                 engine->indexFiles(path);
             }
         }else if (command == "search") {
-            // std::vector<std::string> searchWords;
-            // std::string word;
+            std::vector<std::string> searchWords;
+            std::string word;
+
+            while (iss >> word) {
+                if (word != "AND") {
+                    searchWords.push_back(word);
+                }
+            }
+            if (searchWords.empty()) {
+                std::cout << "Error: Please specify at least one word." << std::endl;
+            } else {
+                engine->searchFiles(searchWords);
+            }
+
+        }else if (command == "bench-tokenizers") {
+            std::string path;
+            if (!(iss >> path)) {
+                std::cout << "Error: Please provide the correct path." << std::endl;
+            } else {
+                engine->benchTokenizers(path);
+            }
+
+        }else if (command == "generate" || command == "sweep") {
+            // generate <directory> [name=value ...], sweep <path> [name=value ...]
+            std::string path;
+            std::vector<std::string> settings;
+            std::string setting;
+            if (!(iss >> path)) {
+                std::cout << "Error: Please provide the correct path." << std::endl;
+            } else {
+                while (iss >> setting) {
+                    settings.push_back(setting);
+                }
+                if (command == "generate") {
+                    engine->generateCorpus(path, settings);
+                } else {
+                    engine->sweep(path, settings);
+                }
+            }
+
+        }else if (command == "save" || command == "load") {
+            std::string path;
+            if (!(iss >> path)) {
+                std::cout << "Error: Please provide the index file path." << std::endl;
+            } else if (command == "save") {
+                engine->saveIndex(path);
+            } else {
+                engine->loadIndex(path);
+            }
 
-            // while (iss >> word) {
-            //     if (word != "AND") {
-            //         searchWords.push_back(word);
-            //     }
-            // }
-            // if (searchWords.empty()) {
-            //     std::cout << "Error: Please specify at least one word." << std::endl;
-            // } else {
-            //     engine->searchFiles(searchWords);
-            // }
-    
         }else{
             std::cout << "unrecognized command!" << std::endl;
         }
@@ -0,0 +1,194 @@
+// BenchmarkHarness.cpp
+
+#include "BenchmarkHarness.hpp"
+#include <algorithm>     // For std::sort, std::min_element, std::max_element
+#include <fcntl.h>       // For posix_fadvise
+#include <fstream>
+#include <iostream>
+#include <numa.h>        // For numa_max_node
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+BenchmarkHarness::BenchmarkHarness(const EngineOptions& options) {
+    this->options = options;
+}
+
+// Write back and drop the cached pages of every file, so the next run reads from disk
+void BenchmarkHarness::evictFromPageCache(const std::vector<CrawledFile>& files) {
+    for (const CrawledFile& file : files) {
+        int fd = open(file.path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            continue;
+        }
+        fdatasync(fd);  // Dirty pages (e.g. a corpus just generated) cannot be dropped
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+bool BenchmarkHarness::sweep(const std::string& path, const SweepSpec& spec, std::string& error) {
+    std::vector<int> threadCounts = spec.threadCounts;
+    if (threadCounts.empty()) {
+        int cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int threads = 1; threads < cpus; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(cpus);
+    }
+
+    DirectoryCrawler crawler(1);
+    std::vector<CrawledFile> files = crawler.crawl(path);
+    std::cout << "Sweep over " << path << ": " << files.size() << " files, " << threadCounts.size()
+              << " thread counts x " << spec.affinityFlags.size() << " affinity settings x "
+              << spec.repeat << " runs" << (spec.coldCache ? ", cold page cache" : ", warm page cache")
+              << std::endl;
+
+    std::vector<RunResult> results;
+    for (int threads : threadCounts) {
+        for (int affinity : spec.affinityFlags) {
+            for (int run = 1; run <= spec.repeat; ++run) {
+                if (spec.coldCache) {
+                    evictFromPageCache(files);
+                }
+
+                // A new engine per run, so every run builds the index from scratch
+                std::ostringstream engineOutput;
+                std::streambuf* console = std::cout.rdbuf(engineOutput.rdbuf());
+                IndexRunStats stats;
+                {
+                    ProcessingEngine engine(threads, affinity, options);
+                    stats = engine.indexFiles(path);
+                }
+                std::cout.rdbuf(console);
+
+                results.push_back({threads, affinity, run, stats});
+                std::cout << "threads=" << threads << " affinity=" << affinity << " run " << run << "/"
+                          << spec.repeat << ": " << stats.totalSeconds << " seconds, "
+                          << stats.throughputMBps << " MB/s" << std::endl;
+            }
+        }
+    }
+
+    if (!writeResults(path, spec, files, results, error)) {
+        return false;
+    }
+    std::cout << "Sweep results written to " << spec.output << std::endl;
+    return true;
+}
+
+namespace {
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+} // namespace
+
+bool BenchmarkHarness::writeResults(const std::string& path, const SweepSpec& spec,
+                                    const std::vector<CrawledFile>& files,
+                                    const std::vector<RunResult>& results, std::string& error) {
+    uintmax_t datasetBytes = 0;
+    for (const CrawledFile& file : files) {
+        datasetBytes += file.size;
+    }
+
+    std::ofstream out(spec.output, std::ios::trunc);
+    out.precision(6);
+    out << "{\n";
+    out << "  \"dataset\": {\"path\": " << jsonString(path) << ", \"files\": " << files.size()
+        << ", \"bytes\": " << datasetBytes << "},\n";
+    out << "  \"host\": {\"cpus\": " << std::thread::hardware_concurrency()
+        << ", \"numa_nodes\": " << numa_max_node() + 1 << "},\n";
+    out << "  \"options\": {\"tokenizer\": " << jsonString(options.tokenizer) << ", \"simd\": "
+        << jsonString(options.simd) << ", \"input\": " << jsonString(options.input) << ", \"loader\": "
+        << jsonString(options.loader) << ", \"cold_cache\": " << (spec.coldCache ? "true" : "false") << "},\n";
+
+    out << "  \"runs\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const RunResult& result = results[i];
+        out << "    {\"threads\": " << result.threads << ", \"affinity\": " << result.affinity
+            << ", \"run\": " << result.run << ", \"files\": " << result.stats.files
+            << ", \"bytes\": " << result.stats.bytes << ", \"tokens\": " << result.stats.tokens
+            << ", \"terms\": " << result.stats.terms << ", \"crawl_seconds\": " << result.stats.crawlSeconds
+            << ", \"merge_seconds\": " << result.stats.mergeSeconds << ", \"total_seconds\": "
+            << result.stats.totalSeconds << ", \"throughput_mb_s\": " << result.stats.throughputMBps << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+
+    // One summary per configuration: medians are robust to a single disturbed run
+    out << "  \"summary\": [\n";
+    for (size_t first = 0; first < results.size();) {
+        size_t last = first;
+        std::vector<double> seconds, throughput;
+        while (last < results.size() && results[last].threads == results[first].threads &&
+               results[last].affinity == results[first].affinity) {
+            seconds.push_back(results[last].stats.totalSeconds);
+            throughput.push_back(results[last].stats.throughputMBps);
+            ++last;
+        }
+        out << "    {\"threads\": " << results[first].threads << ", \"affinity\": " << results[first].affinity
+            << ", \"runs\": " << seconds.size() << ", \"median_seconds\": " << median(seconds)
+            << ", \"min_seconds\": " << *std::min_element(seconds.begin(), seconds.end())
+            << ", \"max_seconds\": " << *std::max_element(seconds.begin(), seconds.end())
+            << ", \"median_throughput_mb_s\": " << median(throughput) << "}"
+            << (last < results.size() ? "," : "") << "\n";
+        first = last;
+    }
+    out << "  ]\n";
+    out << "}\n";
+
+    if (!out) {
+        error = "cannot write " + spec.output;
+        return false;
+    }
+    return true;
+}
+
+bool BenchmarkHarness::parseSetting(const std::string& setting, SweepSpec& spec) {
+    size_t equals = setting.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+    std::string name = setting.substr(0, equals);
+    std::string value = setting.substr(equals + 1);
+
+    // Comma-separated list of non-negative integers
+    auto parseList = [](const std::string& list, std::vector<int>& numbers) {
+        numbers.clear();
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (item.empty() || item.find_first_not_of("0123456789") != std::string::npos) {
+                return false;
+            }
+            numbers.push_back(std::atoi(item.c_str()));
+        }
+        return !numbers.empty();
+    };
+
+    if (name == "threads") {
+        return parseList(value, spec.threadCounts) &&
+               std::find(spec.threadCounts.begin(), spec.threadCounts.end(), 0) == spec.threadCounts.end();
+    }
+    if (name == "affinity") {
+        return parseList(value, spec.affinityFlags) &&
+               std::all_of(spec.affinityFlags.begin(), spec.affinityFlags.end(), [](int flag) { return flag == 0 || flag == 1; });
+    }
+    if (name == "repeat") {
+        spec.repeat = std::atoi(value.c_str());
+        return spec.repeat > 0;
+    }
+    if (name == "cold" && (value == "0" || value == "1")) {
+        spec.coldCache = value == "1";
+        return true;
+    }
+    if (name == "output" && !value.empty()) {
+        spec.output = value;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,156 @@
+// BufferPool.cpp
+
+#include "BufferPool.hpp"
+#include <cstdlib>   // For std::aligned_alloc
+#include <new>       // For std::bad_alloc
+#include <numa.h>    // Include NUMA API
+
+BufferPool::BufferPool(size_t budgetBytes, MemPolicy policy) {
+    this->budget = budgetBytes;
+    this->policy = policy;
+    this->numaAvailable = numa_available() >= 0;
+}
+
+BufferPool::~BufferPool() {
+    for (auto& [key, buffers] : freeBuffers) {
+        for (char* buffer : buffers) {
+            deallocate(buffer, key.second);
+        }
+    }
+}
+
+// Allocate page-aligned memory according to the placement policy
+char* BufferPool::allocate(size_t capacity, int node) {
+    if (!numaAvailable) {
+        return static_cast<char*>(std::aligned_alloc(4096, (capacity + 4095) & ~size_t(4095)));
+    }
+    switch (policy) {
+        case MemPolicy::Local:
+            return static_cast<char*>(numa_alloc_onnode(capacity, node));
+        case MemPolicy::Interleave:
+            return static_cast<char*>(numa_alloc_interleaved(capacity));
+        case MemPolicy::FirstTouchByConsumer:
+        default:
+            // Fresh mapping with no pages yet: they land where they are first written
+            return static_cast<char*>(numa_alloc(capacity));
+    }
+}
+
+void BufferPool::deallocate(char* buffer, size_t capacity) {
+    if (!numaAvailable) {
+        std::free(buffer);
+    } else {
+        numa_free(buffer, capacity);
+    }
+}
+
+// Round a request up to its size class: whole pages for small buffers, then
+// quarter-octave steps so a recycled buffer wastes at most 25% of its capacity
+size_t BufferPool::sizeClass(size_t size) {
+    const size_t pageSize = 4096;
+    if (size <= pageSize) {
+        return pageSize;
+    }
+    int highestBit = 63 - __builtin_clzll(size);
+    size_t step = size_t(1) << (highestBit - 2);
+    return (size + step - 1) & ~(step - 1);
+}
+
+// Free one cached buffer to make room under the budget, returns false if none are cached
+bool BufferPool::evictOne() {
+    for (auto it = freeBuffers.begin(); it != freeBuffers.end(); ++it) {
+        if (!it->second.empty()) {
+            deallocate(it->second.back(), it->first.second);
+            it->second.pop_back();
+            residentBytes -= it->first.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+char* BufferPool::acquire(size_t size, int node, size_t& capacity) {
+    return acquireBuffer(size, node, capacity, true);
+}
+
+char* BufferPool::tryAcquire(size_t size, int node, size_t& capacity) {
+    return acquireBuffer(size, node, capacity, false);
+}
+
+char* BufferPool::acquireBuffer(size_t size, int node, size_t& capacity, bool wait) {
+    capacity = sizeClass(size);
+    if (policy != MemPolicy::Local) {
+        node = -1;  // Placement does not depend on the loader, so share one free list
+    }
+
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (true) {
+        // Reuse a cached buffer of the same class if one is available
+        auto it = freeBuffers.find({node, capacity});
+        if (it != freeBuffers.end() && !it->second.empty()) {
+            char* buffer = it->second.back();
+            it->second.pop_back();
+            inUseBytes += capacity;
+            return buffer;
+        }
+
+        // Allocate a new buffer if it fits in the budget, or if nothing is in use so a
+        // single file larger than the whole budget can still make progress
+        if (budget == 0 || residentBytes + capacity <= budget || inUseBytes == 0) {
+            while (budget != 0 && residentBytes + capacity > budget && evictOne()) {
+            }
+            char* buffer = allocate(capacity, node);
+            if (buffer == nullptr) {
+                throw std::bad_alloc();
+            }
+            residentBytes += capacity;
+            inUseBytes += capacity;
+            if (residentBytes > peakResident) {
+                peakResident = residentBytes;
+            }
+            return buffer;
+        }
+
+        // Drop cached buffers of other classes before making the loader wait
+        if (evictOne()) {
+            continue;
+        }
+
+        // Backpressure: wait until a worker returns a buffer
+        if (!wait) {
+            return nullptr;
+        }
+        bufferReleased.wait(lock);
+    }
+}
+
+void BufferPool::abandon(size_t capacity) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        inUseBytes -= capacity;
+        residentBytes -= capacity;
+    }
+    bufferReleased.notify_all();
+}
+
+void BufferPool::release(char* buffer, int node, size_t capacity) {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        inUseBytes -= capacity;
+        if (policy == MemPolicy::FirstTouchByConsumer) {
+            deallocate(buffer, capacity);
+            residentBytes -= capacity;
+        } else {
+            if (policy != MemPolicy::Local) {
+                node = -1;
+            }
+            freeBuffers[{node, capacity}].push_back(buffer);
+        }
+    }
+    bufferReleased.notify_all();
+}
+
+size_t BufferPool::peakResidentBytes() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return peakResident;
+}
@@ -0,0 +1,214 @@
+// CorpusGenerator.cpp
+
+#include "CorpusGenerator.hpp"
+#include <algorithm>     // For std::upper_bound
+#include <atomic>
+#include <chrono>
+#include <cmath>         // For std::pow, std::log
+#include <cstdio>        // For snprintf
+#include <cstdlib>       // For std::strtoull, std::strtod
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+CorpusGenerator::CorpusGenerator(const CorpusSpec& spec, int numThreads) {
+    this->spec = spec;
+    this->numThreads = numThreads > 0 ? numThreads : 1;
+}
+
+namespace {
+
+// Distinct lowercase words of 2 to 12 letters, in rank order
+std::vector<std::string> buildVocabulary(size_t size, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::geometric_distribution<int> extraLength(0.25);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> words;
+    words.reserve(size);
+    while (words.size() < size) {
+        std::string word(2 + std::min(extraLength(random), 10), ' ');
+        for (char& c : word) {
+            c = static_cast<char>(letter(random));
+        }
+        if (seen.insert(word).second) {
+            words.push_back(std::move(word));
+        }
+    }
+    return words;
+}
+
+// Directory of file i: its number written in base fanout, one digit per level
+std::string directoryOf(size_t file, const CorpusSpec& spec) {
+    std::string path;
+    size_t remaining = file;
+    for (int level = 0; level < spec.directoryDepth; ++level) {
+        char name[16];
+        snprintf(name, sizeof(name), "dir%02zu/", remaining % static_cast<size_t>(spec.directoryFanout));
+        path += name;
+        remaining /= static_cast<size_t>(spec.directoryFanout);
+    }
+    return path;
+}
+
+size_t drawFileSize(std::mt19937_64& random, const CorpusSpec& spec) {
+    double mean = static_cast<double>(spec.meanFileBytes);
+    if (spec.sizeDistribution == "fixed") {
+        return spec.meanFileBytes;
+    }
+    if (spec.sizeDistribution == "uniform") {
+        std::uniform_int_distribution<size_t> uniform(1, 2 * spec.meanFileBytes);
+        return uniform(random);
+    }
+    // Log-normal with sigma 1: a few large files and many small ones, like real datasets
+    std::lognormal_distribution<double> lognormal(std::log(mean) - 0.5, 1.0);
+    return std::max<size_t>(1, static_cast<size_t>(lognormal(random)));
+}
+
+} // namespace
+
+bool CorpusGenerator::generate(const std::string& root, CorpusStats& stats, std::string& error) {
+    auto start = std::chrono::high_resolution_clock::now();
+    stats = CorpusStats();
+
+    // Create every directory that will hold a file
+    std::set<std::string> directories;
+    size_t leaves = std::min(spec.fileCount, static_cast<size_t>(std::pow(spec.directoryFanout, spec.directoryDepth)));
+    for (size_t i = 0; i < leaves; ++i) {
+        std::string directory = directoryOf(i, spec);
+        for (size_t slash = directory.find('/'); slash != std::string::npos; slash = directory.find('/', slash + 1)) {
+            directories.insert(directory.substr(0, slash));
+        }
+    }
+    std::error_code code;
+    std::filesystem::create_directories(root, code);
+    for (const std::string& directory : directories) {
+        std::filesystem::create_directories(root + "/" + directory, code);
+        if (code) {
+            error = "cannot create " + root + "/" + directory + ": " + code.message();
+            return false;
+        }
+    }
+    stats.directories = directories.size();
+
+    // Zipf weights as a cumulative table, sampled by binary search
+    std::vector<std::string> vocabulary = buildVocabulary(spec.vocabularySize, spec.seed);
+    std::vector<double> cumulative(vocabulary.size());
+    double total = 0.0;
+    for (size_t rank = 0; rank < vocabulary.size(); ++rank) {
+        total += 1.0 / std::pow(static_cast<double>(rank + 1), spec.zipfSkew);
+        cumulative[rank] = total;
+    }
+
+    std::atomic<size_t> nextFile{0};
+    std::atomic<uintmax_t> bytesWritten{0};
+    std::mutex errorMutex;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&]() {
+            static const char punctuation[] = ",.;:!?";
+            std::string text;
+            size_t file;
+            while ((file = nextFile.fetch_add(1, std::memory_order_relaxed)) < spec.fileCount) {
+                std::mt19937_64 random(spec.seed + file);
+                std::uniform_real_distribution<double> wordDraw(0.0, total);
+                std::uniform_int_distribution<int> lineLength(6, 16);
+                std::uniform_int_distribution<int> punctuationDraw(0, 7);  // One word in 8
+                std::uniform_int_distribution<size_t> punctuationMark(0, sizeof(punctuation) - 2);
+
+                size_t size = drawFileSize(random, spec);
+                text.clear();
+                int wordsLeftOnLine = lineLength(random);
+                while (text.size() < size) {
+                    size_t rank = std::upper_bound(cumulative.begin(), cumulative.end(), wordDraw(random)) - cumulative.begin();
+                    text += vocabulary[std::min(rank, vocabulary.size() - 1)];
+                    if (punctuationDraw(random) == 0) {
+                        text += punctuation[punctuationMark(random)];
+                    }
+                    if (--wordsLeftOnLine == 0) {
+                        text += '\n';
+                        wordsLeftOnLine = lineLength(random);
+                    } else {
+                        text += ' ';
+                    }
+                }
+                text.resize(size);
+
+                char name[32];
+                snprintf(name, sizeof(name), "file%06zu.txt", file);
+                std::string path = root + "/" + directoryOf(file, spec) + name;
+                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                if (!out) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    error = "cannot write " + path;
+                    nextFile.store(spec.fileCount);  // Stop the other threads
+                    return;
+                }
+                bytesWritten.fetch_add(text.size(), std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!error.empty()) {
+        return false;
+    }
+
+    stats.files = spec.fileCount;
+    stats.bytes = bytesWritten.load();
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+    stats.seconds = duration.count();
+    return true;
+}
+
+bool CorpusGenerator::parseSetting(const std::string& setting, CorpusSpec& spec) {
+    size_t equals = setting.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+    std::string name = setting.substr(0, equals);
+    std::string value = setting.substr(equals + 1);
+    bool isNumber = !value.empty() && value.find_first_not_of("0123456789") == std::string::npos;
+    bool isDecimal = !value.empty() && value.find_first_not_of("0123456789.") == std::string::npos;
+
+    if (name == "files" && isNumber) {
+        spec.fileCount = std::strtoull(value.c_str(), nullptr, 10);
+        return spec.fileCount > 0;
+    }
+    if (name == "mean-kb" && isNumber) {
+        spec.meanFileBytes = std::strtoull(value.c_str(), nullptr, 10) * 1024;
+        return spec.meanFileBytes > 0;
+    }
+    if (name == "size-dist" && (value == "lognormal" || value == "uniform" || value == "fixed")) {
+        spec.sizeDistribution = value;
+        return true;
+    }
+    if (name == "vocabulary" && isNumber) {
+        spec.vocabularySize = std::strtoull(value.c_str(), nullptr, 10);
+        return spec.vocabularySize > 0;
+    }
+    if (name == "zipf" && isDecimal) {
+        spec.zipfSkew = std::strtod(value.c_str(), nullptr);
+        return true;
+    }
+    if (name == "depth" && isNumber) {
+        spec.directoryDepth = std::atoi(value.c_str());
+        return spec.directoryDepth <= 8;
+    }
+    if (name == "fanout" && isNumber) {
+        spec.directoryFanout = std::atoi(value.c_str());
+        return spec.directoryFanout > 0 && spec.directoryFanout <= 100;
+    }
+    if (name == "seed" && isNumber) {
+        spec.seed = std::strtoull(value.c_str(), nullptr, 10);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,202 @@
+// DirectoryCrawler.cpp
+
+#include "DirectoryCrawler.hpp"
+#include <algorithm>     // For std::move
+#include <functional>    // For std::ref
+#include <iterator>      // For std::back_inserter
+#include <cerrno>        // For errno
+#include <cstring>       // For strerror
+#include <dirent.h>      // For the DT_* entry types
+#include <fcntl.h>       // For openat, O_DIRECTORY
+#include <iostream>
+#include <sys/stat.h>    // For fstatat
+#include <sys/syscall.h> // For SYS_getdents64
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Record layout returned by getdents64 (glibc does not export it)
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+std::string joinPath(const std::string& directory, const char* name) {
+    std::string path;
+    path.reserve(directory.size() + 1 + strlen(name));
+    path = directory;
+    if (path.empty() || path.back() != '/') {
+        path += '/';
+    }
+    path += name;
+    return path;
+}
+
+CrawledFile crawledFile(std::string path, const struct stat& info) {
+    int64_t modifiedNs = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    return {std::move(path), static_cast<uintmax_t>(info.st_size), modifiedNs, static_cast<uint64_t>(info.st_ino)};
+}
+
+} // namespace
+
+DirectoryCrawler::DirectoryCrawler(int numThreads) {
+    this->numThreads = numThreads > 0 ? numThreads : 1;
+}
+
+std::vector<CrawledFile> DirectoryCrawler::crawl(const std::string& root) {
+    std::vector<CrawledFile> fileInfos;
+
+    int rootFd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd == -1) {
+        std::cerr << "Filesystem error: cannot open directory " << root << ": " << strerror(errno) << std::endl;
+        return fileInfos;
+    }
+
+    // Keep the root spelled as given, minus trailing slashes, so paths match the old crawler
+    std::string rootPath = root;
+    while (rootPath.size() > 1 && rootPath.back() == '/') {
+        rootPath.pop_back();
+    }
+    pending.push_back({rootFd, rootPath});
+    openDirectories = 1;
+    activeScans = 0;
+    directoryCount = 0;
+
+    // Every thread collects into its own vector; they are concatenated at the end
+    std::vector<std::vector<CrawledFile>> filesPerThread(numThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(&DirectoryCrawler::crawlWorker, this, std::ref(filesPerThread[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t total = 0;
+    for (const auto& files : filesPerThread) {
+        total += files.size();
+    }
+    fileInfos.reserve(total);
+    for (auto& files : filesPerThread) {
+        std::move(files.begin(), files.end(), std::back_inserter(fileInfos));
+    }
+    return fileInfos;
+}
+
+void DirectoryCrawler::crawlWorker(std::vector<CrawledFile>& files) {
+    std::vector<char> entryBuffer(64 * 1024);
+    while (true) {
+        PendingDirectory directory;
+        {
+            std::unique_lock<std::mutex> lock(stackMutex);
+            // The crawl is over once nothing is queued and no scan can queue more
+            directoryQueued.wait(lock, [this] { return !pending.empty() || activeScans == 0; });
+            if (pending.empty()) {
+                return;
+            }
+            directory = std::move(pending.back());
+            pending.pop_back();
+            if (directory.fd != -1) {
+                openDirectories--;
+            }
+            activeScans++;
+            directoryCount++;
+        }
+
+        scanDirectory(directory, entryBuffer, files);
+
+        std::lock_guard<std::mutex> lock(stackMutex);
+        activeScans--;
+        if (activeScans == 0 && pending.empty()) {
+            directoryQueued.notify_all();
+        }
+    }
+}
+
+void DirectoryCrawler::scanDirectory(PendingDirectory& directory,
+                                     std::vector<char>& entryBuffer,
+                                     std::vector<CrawledFile>& files) {
+    int fd = directory.fd;
+    if (fd == -1) {
+        fd = open(directory.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1) {
+            std::lock_guard<std::mutex> lock(stackMutex);
+            std::cerr << "Error opening directory: " << directory.path << " - " << strerror(errno) << std::endl;
+            return;
+        }
+    }
+
+    std::vector<PendingDirectory> subdirectories;
+    while (true) {
+        long count = syscall(SYS_getdents64, fd, entryBuffer.data(), entryBuffer.size());
+        if (count <= 0) {
+            if (count < 0) {
+                std::lock_guard<std::mutex> lock(stackMutex);
+                std::cerr << "Error reading directory: " << directory.path << " - " << strerror(errno) << std::endl;
+            }
+            break;
+        }
+
+        for (long offset = 0; offset < count;) {
+            const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(entryBuffer.data() + offset);
+            offset += entry->d_reclen;
+
+            // Prune hidden entries (and "." / "..") before they cost a stat or a path string
+            const char* name = entry->d_name;
+            if (name[0] == '.') {
+                continue;
+            }
+
+            unsigned char type = entry->d_type;
+            struct stat info;
+            if (type == DT_DIR) {
+                // Open it through this directory's descriptor while we have one, unless
+                // queued directories already hold too many; then it is opened by path later
+                bool reserved;
+                {
+                    std::lock_guard<std::mutex> lock(stackMutex);
+                    reserved = openDirectories < maxOpenDirectories;
+                    openDirectories += reserved;
+                }
+                int childFd = reserved ? openat(fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+                if (reserved && childFd == -1) {
+                    std::lock_guard<std::mutex> lock(stackMutex);
+                    openDirectories--;
+                }
+                subdirectories.push_back({childFd, joinPath(directory.path, name)});
+                continue;
+            }
+            if (type == DT_REG) {
+                if (fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) == 0) {
+                    files.push_back(crawledFile(joinPath(directory.path, name), info));
+                }
+                continue;
+            }
+            if (type == DT_LNK || type == DT_UNKNOWN) {
+                // Symlinks to files count as files; symlinked directories are not followed
+                if (fstatat(fd, name, &info, type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) != 0) {
+                    continue;
+                }
+                if (S_ISREG(info.st_mode)) {
+                    files.push_back(crawledFile(joinPath(directory.path, name), info));
+                } else if (S_ISDIR(info.st_mode) && type == DT_UNKNOWN) {
+                    subdirectories.push_back({-1, joinPath(directory.path, name)});
+                }
+            }
+        }
+    }
+
+    close(fd);
+
+    if (!subdirectories.empty()) {
+        std::lock_guard<std::mutex> lock(stackMutex);
+        for (auto& subdirectory : subdirectories) {
+            pending.push_back(std::move(subdirectory));
+        }
+        directoryQueued.notify_all();
+    }
+}
@@ -0,0 +1,146 @@
+// IndexImage.cpp
+
+#include "IndexImage.hpp"
+#include <cerrno>        // For errno
+#include <cstring>       // For memcmp, strerror
+#include <fcntl.h>
+#include <nmmintrin.h>   // SSE4.2 CRC32 instructions
+#include <sys/mman.h>    // For mmap, munmap
+#include <sys/stat.h>    // For fstat
+#include <unistd.h>
+
+static uint32_t crc32cSoftware(const uint8_t* bytes, size_t size) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value >> 1) ^ (0x82F63B78u & (0u - (value & 1)));
+            }
+            table[i] = value;
+        }
+        tableReady = true;
+    }
+    uint32_t crc = ~0u;
+    for (size_t i = 0; i < size; ++i) {
+        crc = (crc >> 8) ^ table[(crc ^ bytes[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32cHardware(const uint8_t* bytes, size_t size) {
+    uint64_t crc = ~0u;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        crc = _mm_crc32_u64(crc, word);
+        bytes += 8;
+        size -= 8;
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc);
+    while (size > 0) {
+        crc32 = _mm_crc32_u8(crc32, *bytes++);
+        --size;
+    }
+    return ~crc32;
+}
+
+uint32_t crc32c(const void* data, size_t size) {
+    static const bool hasSse42 = __builtin_cpu_supports("sse4.2");
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    return hasSse42 ? crc32cHardware(bytes, size) : crc32cSoftware(bytes, size);
+}
+
+IndexImage::~IndexImage() {
+    if (mapping != nullptr) {
+        munmap(mapping, mappingBytes);
+    }
+}
+
+std::unique_ptr<IndexImage> IndexImage::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        error = std::string("cannot open file: ") + strerror(errno);
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(IndexImageHeader)) {
+        close(fd);
+        error = "file is too small to be an index image";
+        return nullptr;
+    }
+
+    std::unique_ptr<IndexImage> image(new IndexImage());
+    image->mappingBytes = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, image->mappingBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        error = std::string("cannot map file: ") + strerror(errno);
+        return nullptr;
+    }
+    image->mapping = mapping;
+
+    const char* base = static_cast<const char*>(mapping);
+    const IndexImageHeader* header = reinterpret_cast<const IndexImageHeader*>(base);
+    if (memcmp(header->magic, indexImageMagic, sizeof(indexImageMagic)) != 0) {
+        error = "not an index image";
+        return nullptr;
+    }
+    if (header->version != indexImageVersion) {
+        error = "unsupported index image version " + std::to_string(header->version) +
+                " (expected " + std::to_string(indexImageVersion) + ")";
+        return nullptr;
+    }
+
+    // Every section must lie inside the file before anything is dereferenced
+    uint64_t size = image->mappingBytes;
+    bool valid = header->fileBytes == size && header->headerBytes == sizeof(IndexImageHeader) &&
+                 header->termSlotCount != 0 && (header->termSlotCount & (header->termSlotCount - 1)) == 0 &&
+                 header->documentsOffset >= header->headerBytes &&
+                 header->termCount < header->termSlotCount &&
+                 header->documentsOffset + header->documentCount * sizeof(ImageDocument) <= header->termsOffset &&
+                 header->termsOffset + header->termCount * sizeof(ImageTerm) <= header->slotsOffset &&
+                 header->slotsOffset + header->termSlotCount * sizeof(uint32_t) <= header->postingsOffset &&
+                 header->postingsOffset <= header->stringsOffset && header->stringsOffset <= size;
+    if (!valid) {
+        error = "index image is truncated or corrupt";
+        return nullptr;
+    }
+    if (crc32c(base + header->headerBytes, size - header->headerBytes) != header->checksum) {
+        error = "index image checksum mismatch";
+        return nullptr;
+    }
+
+    image->header = header;
+    image->documents = reinterpret_cast<const ImageDocument*>(base + header->documentsOffset);
+    image->terms = reinterpret_cast<const ImageTerm*>(base + header->termsOffset);
+    image->slots = reinterpret_cast<const uint32_t*>(base + header->slotsOffset);
+    image->postings = reinterpret_cast<const uint32_t*>(base + header->postingsOffset);
+    image->strings = base + header->stringsOffset;
+    return image;
+}
+
+std::string IndexImage::getDocument(size_t documentNumber) const {
+    if (documentNumber >= header->documentCount) {
+        return "";
+    }
+    const ImageDocument& document = documents[documentNumber];
+    return std::string(strings + document.pathOffset, document.pathLength);
+}
+
+bool IndexImage::findPostings(const char* term, size_t length, uint64_t hash, PostingsView& result) const {
+    uint64_t mask = header->termSlotCount - 1;
+    for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+        if (slots[i] == 0) {
+            return false;
+        }
+        const ImageTerm& candidate = terms[slots[i] - 1];
+        if (candidate.hash == hash && candidate.termLength == length &&
+            memcmp(strings + candidate.termOffset, term, length) == 0) {
+            result = PostingsView(postings + candidate.postingsOffset, candidate.postingCount);
+            return true;
+        }
+    }
+}
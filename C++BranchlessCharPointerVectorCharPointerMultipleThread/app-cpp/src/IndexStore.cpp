@@ -0,0 +1,453 @@
+// IndexStore.cpp
+
+#include "IndexStore.hpp"
+#include <algorithm>     // For std::sort, std::is_sorted, std::remove_if, std::fill
+#include <cerrno>        // For errno
+#include <cstdio>        // For std::rename
+#include <cstring>       // For memcpy, strerror
+#include <fcntl.h>
+#include <iterator>      // For std::make_move_iterator
+#include <unistd.h>
+
+IndexStore::IndexStore() : partitions(indexPartitionCount) {
+}
+
+long IndexStore::putDocument(const std::string& documentPath, const DocumentIdentity& identity) {
+    std::lock_guard<std::mutex> lock(documentMutex);
+    auto [it, inserted] = documentMap.emplace(documentPath, static_cast<long>(documents.size()));
+    if (inserted) {
+        documents.push_back({documentPath, identity, true});
+        retiredDocuments.push_back(false);
+        liveDocuments++;
+        return it->second;
+    }
+    // Indexed before: the stored postings are from the old contents (or the file was
+    // deleted and has come back)
+    DocumentRecord& document = documents[it->second];
+    if (!retiredDocuments[it->second]) {
+        retiredDocuments[it->second] = true;
+        retiredCount++;
+    }
+    if (!document.live) {
+        document.live = true;
+        liveDocuments++;
+    }
+    document.identity = identity;
+    return it->second;
+}
+
+bool IndexStore::isCurrent(const std::string& documentPath, const DocumentIdentity& identity) {
+    std::lock_guard<std::mutex> lock(documentMutex);
+    auto it = documentMap.find(documentPath);
+    if (it == documentMap.end()) {
+        return false;
+    }
+    const DocumentRecord& document = documents[it->second];
+    return document.live && document.identity == identity;
+}
+
+size_t IndexStore::removeMissingDocuments(const std::string& root, const std::unordered_set<std::string>& present) {
+    // Paths below root start with root and a slash (the crawler drops trailing slashes)
+    std::string prefix = root;
+    while (prefix.size() > 1 && prefix.back() == '/') {
+        prefix.pop_back();
+    }
+    if (prefix.back() != '/') {
+        prefix += '/';
+    }
+    std::lock_guard<std::mutex> lock(documentMutex);
+    size_t removed = 0;
+    for (size_t d = 0; d < documents.size(); ++d) {
+        DocumentRecord& document = documents[d];
+        if (!document.live || document.path.compare(0, prefix.size(), prefix) != 0 || present.count(document.path)) {
+            continue;
+        }
+        document.live = false;
+        liveDocuments--;
+        if (!retiredDocuments[d]) {
+            retiredDocuments[d] = true;
+            retiredCount++;
+        }
+        removed++;
+    }
+    return removed;
+}
+
+void IndexStore::clearRetiredDocuments() {
+    std::lock_guard<std::mutex> lock(documentMutex);
+    std::fill(retiredDocuments.begin(), retiredDocuments.end(), false);
+    retiredCount = 0;
+}
+
+long IndexStore::findDocument(const std::string& documentPath) {
+    std::lock_guard<std::mutex> lock(documentMutex);
+    if (image) {
+        for (size_t i = 0; i < image->documentCount(); ++i) {
+            if (image->getDocument(i) == documentPath) {
+                return static_cast<long>(i);
+            }
+        }
+        return -1;
+    }
+    auto it = documentMap.find(documentPath);
+    return it != documentMap.end() ? it->second : -1;
+}
+
+std::string IndexStore::getDocument(long documentNumber) {
+    std::lock_guard<std::mutex> lock(documentMutex);
+    if (image) {
+        return documentNumber < 0 ? "" : image->getDocument(static_cast<size_t>(documentNumber));
+    }
+    if (documentNumber < 0 || static_cast<size_t>(documentNumber) >= documents.size()) {
+        return "";
+    }
+    return documents[documentNumber].path;
+}
+
+// Sort postings by document and fold entries of the same document together
+void IndexStore::normalizePostings(std::vector<DocFreqPair>& postings) {
+    auto byDocument = [](const DocFreqPair& a, const DocFreqPair& b) {
+        return a.documentNumber < b.documentNumber;
+    };
+    if (!std::is_sorted(postings.begin(), postings.end(), byDocument)) {
+        std::sort(postings.begin(), postings.end(), byDocument);
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < postings.size(); ++i) {
+        if (out > 0 && postings[out - 1].documentNumber == postings[i].documentNumber) {
+            postings[out - 1].wordFrequency += postings[i].wordFrequency;
+        } else {
+            postings[out++] = postings[i];
+        }
+    }
+    postings.resize(out);
+}
+
+void IndexStore::mergePartition(size_t partitionIndex, std::vector<LocalTermTable>& localTables) {
+    Partition& partition = partitions[partitionIndex];
+    std::lock_guard<std::mutex> lock(partition.partitionMutex);
+    TermDictionary<TermPostings>& index = partition.termInvertedIndex;
+
+    // Collect postings, reusing each term's stored hash; a term first seen in this
+    // partition takes the local vector as is
+    for (LocalTermTable& localTable : localTables) {
+        PostingsTable& local = localTable.partition(partitionIndex);
+        local.forEach([&](const PostingsTable::Slot& slot, std::vector<DocFreqPair>& postings) {
+            TermPostings& target = index.findOrInsert(slot.term, slot.length, slot.hash, partition.termArena);
+            if (target.pending.empty()) {
+                target.pending = std::move(postings);
+            } else {
+                target.pending.insert(target.pending.end(), std::make_move_iterator(postings.begin()),
+                                      std::make_move_iterator(postings.end()));
+            }
+        });
+        local.clear();  // Free the local table as soon as it is merged
+    }
+
+    // Workers take files in any order and chunks of a file may be counted by two workers,
+    // so collected postings are sorted and folded (already sorted ones only pay for the
+    // is_sorted check), joined with what an earlier build stored, and compressed. When
+    // documents were retired every stored list is decoded to drop their postings.
+    const bool purge = retiredCount > 0;
+    size_t emptiedTerms = 0;
+    std::vector<DocFreqPair> merged;
+    index.forEach([&](const TermDictionary<TermPostings>::Slot&, TermPostings& postings) {
+        if (postings.compressed.size() == 0) {
+            // New term: the collected postings are all there is
+            if (!postings.pending.empty()) {
+                normalizePostings(postings.pending);
+                postings.compressed.encode(postings.pending);
+                std::vector<DocFreqPair>().swap(postings.pending);
+            }
+            return;
+        }
+        if (postings.pending.empty() && !purge) {
+            return;
+        }
+        merged.clear();
+        postings.compressed.decode(merged);
+        size_t stored = merged.size();
+        if (purge) {
+            merged.erase(std::remove_if(merged.begin(), merged.end(), [this](const DocFreqPair& posting) {
+                             return retiredDocuments[posting.documentNumber];
+                         }),
+                         merged.end());
+        }
+        if (postings.pending.empty() && merged.size() == stored) {
+            return;  // None of this term's documents were retired
+        }
+        merged.insert(merged.end(), postings.pending.begin(), postings.pending.end());
+        normalizePostings(merged);
+        postings.compressed.encode(merged);
+        std::vector<DocFreqPair>().swap(postings.pending);
+        emptiedTerms += merged.empty() ? 1 : 0;
+    });
+
+    // Terms that only occurred in retired documents leave the dictionary, so they are
+    // neither counted nor written into saved images
+    if (emptiedTerms > 0) {
+        index.eraseIf([](const TermDictionary<TermPostings>::Slot&, TermPostings& postings) {
+            return postings.compressed.size() == 0;
+        });
+    }
+}
+
+std::vector<DocFreqPair> IndexStore::lookupIndex(const std::string& term) {
+    std::vector<DocFreqPair> postings;
+    uint64_t hash = hashTerm(term.data(), term.size());
+    PostingsView imagePostings;
+    if (image) {
+        if (image->findPostings(term.data(), term.size(), hash, imagePostings)) {
+            imagePostings.decode(postings);
+        }
+        return postings;
+    }
+    Partition& partition = partitions[termPartition(hash)];
+    std::lock_guard<std::mutex> lock(partition.partitionMutex);
+    TermPostings* termPostings = partition.termInvertedIndex.find(term.data(), term.size(), hash);
+    if (termPostings != nullptr) {
+        termPostings->compressed.decode(postings);
+    }
+    return postings;
+}
+
+bool IndexStore::findPostings(const std::string& term, PostingsView& postings) {
+    uint64_t hash = hashTerm(term.data(), term.size());
+    if (image) {
+        return image->findPostings(term.data(), term.size(), hash, postings);
+    }
+    Partition& partition = partitions[termPartition(hash)];
+    std::lock_guard<std::mutex> lock(partition.partitionMutex);
+    TermPostings* termPostings = partition.termInvertedIndex.find(term.data(), term.size(), hash);
+    if (termPostings == nullptr) {
+        return false;
+    }
+    postings = termPostings->compressed.view();
+    return true;
+}
+
+size_t IndexStore::documentCount() {
+    std::lock_guard<std::mutex> lock(documentMutex);
+    return image ? image->liveDocumentCount() : liveDocuments;
+}
+
+size_t IndexStore::termCount() {
+    if (image) {
+        return image->termCount();
+    }
+    size_t total = 0;
+    for (size_t p = 0; p < partitions.size(); ++p) {
+        total += partitionTermCount(p);
+    }
+    return total;
+}
+
+size_t IndexStore::partitionTermCount(size_t partitionIndex) {
+    Partition& partition = partitions[partitionIndex];
+    std::lock_guard<std::mutex> lock(partition.partitionMutex);
+    return partition.termInvertedIndex.size();
+}
+
+void IndexStore::termStorageBytes(size_t& arenaBytesUsed, size_t& arenaBytesReserved, size_t& tableBytes) {
+    arenaBytesUsed = 0;
+    arenaBytesReserved = 0;
+    tableBytes = 0;
+    for (Partition& partition : partitions) {
+        std::lock_guard<std::mutex> lock(partition.partitionMutex);
+        arenaBytesUsed += partition.termArena.bytesUsed();
+        arenaBytesReserved += partition.termArena.bytesReserved();
+        tableBytes += partition.termInvertedIndex.memoryBytes();
+    }
+}
+
+void IndexStore::postingsStorage(size_t& postingCount, size_t& compressedBytes) {
+    postingCount = 0;
+    compressedBytes = 0;
+    for (Partition& partition : partitions) {
+        std::lock_guard<std::mutex> lock(partition.partitionMutex);
+        partition.termInvertedIndex.forEach([&](const TermDictionary<TermPostings>::Slot&, TermPostings& postings) {
+            postingCount += postings.compressed.size();
+            compressedBytes += postings.compressed.memoryBytes();
+        });
+    }
+}
+
+size_t IndexStore::decodeAllPostings() {
+    uint32_t documents[CompressedPostings::blockSize];
+    uint32_t frequencies[CompressedPostings::blockSize];
+    size_t decoded = 0;
+    for (Partition& partition : partitions) {
+        std::lock_guard<std::mutex> lock(partition.partitionMutex);
+        partition.termInvertedIndex.forEach([&](const TermDictionary<TermPostings>::Slot&, TermPostings& postings) {
+            PostingsView view = postings.compressed.view();
+            for (size_t block = 0; block < view.blockCount(); ++block) {
+                decoded += view.decodeBlock(block, documents, frequencies);
+            }
+        });
+    }
+    return decoded;
+}
+
+// Round up to the next multiple of 8 so every image section stays 8-byte aligned
+static size_t alignSection(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+static bool writeFile(const std::string& path, const char* data, size_t size, std::string& error) {
+    std::string temporaryPath = path + ".tmp";
+    int fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        error = "cannot create " + temporaryPath + ": " + strerror(errno);
+        return false;
+    }
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = write(fd, data + written, size - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            error = "cannot write " + temporaryPath + ": " + strerror(errno);
+            close(fd);
+            unlink(temporaryPath.c_str());
+            return false;
+        }
+        written += static_cast<size_t>(result);
+    }
+    // The rename only replaces an existing image once the new one is on disk
+    if (fsync(fd) != 0 || close(fd) != 0) {
+        error = "cannot write " + temporaryPath + ": " + strerror(errno);
+        unlink(temporaryPath.c_str());
+        return false;
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + temporaryPath + " to " + path + ": " + strerror(errno);
+        unlink(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool IndexStore::save(const std::string& path, std::string& error) {
+    if (image) {
+        return writeFile(path, static_cast<const char*>(image->data()), image->fileBytes(), error);
+    }
+
+    // Size every section first, so the image is built in one allocation
+    std::lock_guard<std::mutex> documentLock(documentMutex);
+    std::vector<std::unique_lock<std::mutex>> partitionLocks;
+    size_t termTotal = 0;
+    size_t postingsWords = 0;
+    size_t stringBytes = 0;
+    for (Partition& partition : partitions) {
+        partitionLocks.emplace_back(partition.partitionMutex);
+        partition.termInvertedIndex.forEach([&](const TermDictionary<TermPostings>::Slot& slot, TermPostings& postings) {
+            ++termTotal;
+            postingsWords += postings.compressed.wordCount();
+            stringBytes += slot.length;
+        });
+    }
+    for (const DocumentRecord& document : documents) {
+        stringBytes += document.path.size();
+    }
+    size_t slotCount = 1;
+    while (slotCount < 2 * termTotal) {
+        slotCount *= 2;
+    }
+
+    IndexImageHeader header = {};
+    memcpy(header.magic, indexImageMagic, sizeof(indexImageMagic));
+    header.version = indexImageVersion;
+    header.headerBytes = sizeof(IndexImageHeader);
+    header.documentCount = documents.size();
+    header.liveDocumentCount = liveDocuments;
+    header.termCount = termTotal;
+    header.termSlotCount = slotCount;
+    header.documentsOffset = alignSection(sizeof(IndexImageHeader));
+    header.termsOffset = alignSection(header.documentsOffset + documents.size() * sizeof(ImageDocument));
+    header.slotsOffset = alignSection(header.termsOffset + termTotal * sizeof(ImageTerm));
+    header.postingsOffset = alignSection(header.slotsOffset + slotCount * sizeof(uint32_t));
+    header.stringsOffset = alignSection(header.postingsOffset + postingsWords * sizeof(uint32_t));
+    header.fileBytes = header.stringsOffset + stringBytes;
+
+    std::vector<char> buffer(header.fileBytes, 0);
+    ImageDocument* imageDocuments = reinterpret_cast<ImageDocument*>(buffer.data() + header.documentsOffset);
+    ImageTerm* terms = reinterpret_cast<ImageTerm*>(buffer.data() + header.termsOffset);
+    uint32_t* slots = reinterpret_cast<uint32_t*>(buffer.data() + header.slotsOffset);
+    uint32_t* postingsOut = reinterpret_cast<uint32_t*>(buffer.data() + header.postingsOffset);
+    char* strings = buffer.data() + header.stringsOffset;
+    size_t stringOffset = 0;
+    size_t wordOffset = 0;
+    uint32_t termNumber = 0;
+
+    for (size_t d = 0; d < documents.size(); ++d) {
+        const DocumentRecord& document = documents[d];
+        imageDocuments[d] = {stringOffset, document.path.size(), document.identity.size,
+                             document.identity.modifiedNs, document.identity.inode, document.live};
+        memcpy(strings + stringOffset, document.path.data(), document.path.size());
+        stringOffset += document.path.size();
+    }
+    for (Partition& partition : partitions) {
+        partition.termInvertedIndex.forEach([&](const TermDictionary<TermPostings>::Slot& slot, TermPostings& postings) {
+            const CompressedPostings& compressed = postings.compressed;
+            size_t i = slot.hash & (slotCount - 1);
+            while (slots[i] != 0) {
+                i = (i + 1) & (slotCount - 1);
+            }
+            terms[termNumber] = {slot.hash, stringOffset, static_cast<uint32_t>(slot.length),
+                                 static_cast<uint32_t>(compressed.size()), wordOffset, compressed.wordCount()};
+            slots[i] = ++termNumber;
+            memcpy(strings + stringOffset, slot.term, slot.length);
+            stringOffset += slot.length;
+            memcpy(postingsOut + wordOffset, compressed.data(), compressed.memoryBytes());
+            wordOffset += compressed.wordCount();
+        });
+    }
+
+    header.checksum = crc32c(buffer.data() + header.headerBytes, header.fileBytes - header.headerBytes);
+    memcpy(buffer.data(), &header, sizeof(header));
+    return writeFile(path, buffer.data(), buffer.size(), error);
+}
+
+bool IndexStore::load(const std::string& path, std::string& error) {
+    std::unique_ptr<IndexImage> loaded = IndexImage::open(path, error);
+    if (!loaded) {
+        return false;
+    }
+    std::lock_guard<std::mutex> documentLock(documentMutex);
+    documentMap.clear();
+    documents.clear();
+    liveDocuments = 0;
+    retiredDocuments.clear();
+    retiredCount = 0;
+    for (Partition& partition : partitions) {
+        std::lock_guard<std::mutex> lock(partition.partitionMutex);
+        partition.termInvertedIndex.clear();
+        partition.termArena.clear();
+    }
+    image = std::move(loaded);
+    return true;
+}
+
+void IndexStore::materializeImage() {
+    if (!image) {
+        return;
+    }
+    std::lock_guard<std::mutex> documentLock(documentMutex);
+    for (size_t d = 0; d < image->documentCount(); ++d) {
+        const ImageDocument& record = image->documentRecord(d);
+        std::string documentPath = image->getDocument(d);
+        documentMap.emplace(documentPath, static_cast<long>(documents.size()));
+        documents.push_back({std::move(documentPath), {record.size, record.modifiedNs, record.inode}, record.live != 0});
+        retiredDocuments.push_back(false);
+        liveDocuments += record.live != 0;
+    }
+    image->forEachTerm([&](const char* term, size_t length, uint64_t hash, const PostingsView& view,
+                           const uint32_t* words, size_t wordCount) {
+        Partition& partition = partitions[termPartition(hash)];
+        std::lock_guard<std::mutex> lock(partition.partitionMutex);
+        TermPostings& postings = partition.termInvertedIndex.findOrInsert(term, length, hash, partition.termArena);
+        postings.compressed.assign(static_cast<uint32_t>(view.size()), words, wordCount);
+    });
+    image.reset();
+}
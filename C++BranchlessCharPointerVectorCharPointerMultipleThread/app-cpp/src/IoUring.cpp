@@ -0,0 +1,162 @@
+// IoUring.cpp
+
+#include "IoUring.hpp"
+#include <cstring>       // For memset
+#include <sys/mman.h>    // For mmap
+#include <sys/syscall.h> // For SYS_io_uring_setup / _enter / _register
+#include <unistd.h>
+#include <vector>
+
+IoUring::~IoUring() {
+    if (sqes != nullptr) {
+        munmap(sqes, sqesSize);
+    }
+    if (cqRing != nullptr && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    if (sqRing != nullptr) {
+        munmap(sqRing, sqRingSize);
+    }
+    if (ringFd != -1) {
+        close(ringFd);
+    }
+}
+
+bool IoUring::init(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = static_cast<int>(syscall(SYS_io_uring_setup, entries, &params));
+    if (fd < 0) {
+        return false;  // ENOSYS, EPERM (seccomp / io_uring_disabled), ...
+    }
+    ringFd = fd;
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) {
+        sqRingSize = cqRingSize = (sqRingSize > cqRingSize) ? sqRingSize : cqRingSize;
+    }
+
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        return false;
+    }
+    if (singleMmap) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            return false;
+        }
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqeMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqeMemory == MAP_FAILED) {
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+    char* sq = static_cast<char*>(sqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    char* cq = static_cast<char*>(cqRing);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    probeOps();
+    return true;
+}
+
+void IoUring::probeOps() {
+    // io_uring_probe ends in a flexible array of one entry per opcode
+    const unsigned opCount = 256;
+    std::vector<char> memory(sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+
+    supportedOps.reset();
+    if (syscall(SYS_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, opCount) < 0) {
+        return;  // EINVAL before 5.6: leave every opcode unsupported
+    }
+    for (unsigned i = 0; i < probe->ops_len && i < opCount; ++i) {
+        if (probe->ops[i].flags & IO_URING_OP_SUPPORTED) {
+            supportedOps.set(probe->ops[i].op);
+        }
+    }
+}
+
+io_uring_sqe* IoUring::getSqe() {
+    io_uring_sqe* sqe;
+    return getSqes(&sqe, 1) ? sqe : nullptr;
+}
+
+bool IoUring::getSqes(io_uring_sqe** sqesOut, unsigned count) {
+    unsigned entries = *sqMask + 1;
+    unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *sqTail + pendingSubmit;
+    if (entries - (tail - head) < count && pendingSubmit > 0) {
+        // Full of prepared entries: hand them to the kernel to make room
+        submitAndWait(0);
+        head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        tail = *sqTail + pendingSubmit;
+    }
+    if (entries - (tail - head) < count) {
+        return false;  // Submission queue full
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        unsigned index = (tail + i) & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        sqesOut[i] = sqe;
+    }
+    pendingSubmit += count;
+    return true;
+}
+
+int IoUring::submitAndWait(unsigned waitCount) {
+    unsigned toSubmit = pendingSubmit;
+    if (toSubmit > 0) {
+        // Publish the prepared entries to the kernel
+        __atomic_store_n(sqTail, *sqTail + toSubmit, __ATOMIC_RELEASE);
+        pendingSubmit = 0;
+    }
+    unsigned flags = waitCount > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (toSubmit == 0 && waitCount == 0) {
+        return 0;
+    }
+    return static_cast<int>(syscall(SYS_io_uring_enter, ringFd, toSubmit, waitCount, flags, nullptr, 0));
+}
+
+void IoUring::withdrawUnconsumed(std::vector<uint64_t>& userData) {
+    unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *sqTail + pendingSubmit;
+    for (unsigned position = head; position != tail; ++position) {
+        userData.push_back(sqes[sqArray[position & *sqMask]].user_data);
+    }
+    // Without SQPOLL the kernel only reads the tail inside io_uring_enter, so it can be
+    // moved back between calls
+    __atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+    pendingSubmit = 0;
+}
+
+bool IoUring::popCompletion(uint64_t& userData, int& result) {
+    unsigned head = *cqHead;
+    if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    io_uring_cqe* cqe = &cqes[head & *cqMask];
+    userData = cqe->user_data;
+    result = cqe->res;
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
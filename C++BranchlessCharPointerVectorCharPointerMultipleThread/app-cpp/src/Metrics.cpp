@@ -0,0 +1,231 @@
+// Metrics.cpp
+
+#include "Metrics.hpp"
+#include <cstdio>        // For snprintf
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(subBucketCount)) {
+        return static_cast<int>(value);
+    }
+    int shift = 63 - __builtin_clzll(value) - subBucketBits;
+    return (shift + 1) * subBucketCount + static_cast<int>((value >> shift) & (subBucketCount - 1));
+}
+
+uint64_t LatencyHistogram::bucketHighest(int index) {
+    if (index < subBucketCount) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / subBucketCount - 1;
+    uint64_t lowest = static_cast<uint64_t>(subBucketCount + index % subBucketCount) << shift;
+    return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    counts[bucketIndex(value)]++;
+    total++;
+    sum += value;
+    minimum = value < minimum ? value : minimum;
+    maximum = value > maximum ? value : maximum;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < bucketCount; ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    minimum = other.minimum < minimum ? other.minimum : minimum;
+    maximum = other.maximum > maximum ? other.maximum : maximum;
+}
+
+uint64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+    // Rank of the value asked for, at least the first one
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * total + 0.5);
+    rank = rank == 0 ? 1 : (rank > total ? total : rank);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            uint64_t highest = bucketHighest(i);
+            return highest < maximum ? highest : maximum;
+        }
+    }
+    return maximum;
+}
+
+std::string jsonString(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+namespace {
+
+// Percentiles reported for every histogram, with the suffix used in their names
+const struct {
+    double percentile;
+    const char* name;
+} reportedPercentiles[] = {{50.0, "p50"}, {90.0, "p90"}, {99.0, "p99"}, {99.9, "p999"}};
+
+double microseconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1000.0;
+}
+
+// Histogram summary as a JSON object, in microseconds
+void writeHistogramJson(const LatencyHistogram& histogram, std::ostream& out) {
+    out << "{\"count\": " << histogram.count() << ", \"min\": " << microseconds(histogram.min())
+        << ", \"mean\": " << histogram.mean() / 1000.0;
+    for (const auto& reported : reportedPercentiles) {
+        out << ", \"" << reported.name << "\": " << microseconds(histogram.valueAtPercentile(reported.percentile));
+    }
+    out << ", \"max\": " << microseconds(histogram.max()) << "}";
+}
+
+// Histogram summary as CSV rows named <name>_<statistic>_us
+void writeHistogramCsv(const char* scope, int id, const std::string& name, const LatencyHistogram& histogram,
+                       std::ostream& out) {
+    out << scope << "," << id << "," << name << "_count," << histogram.count() << "\n";
+    out << scope << "," << id << "," << name << "_min_us," << microseconds(histogram.min()) << "\n";
+    out << scope << "," << id << "," << name << "_mean_us," << histogram.mean() / 1000.0 << "\n";
+    for (const auto& reported : reportedPercentiles) {
+        out << scope << "," << id << "," << name << "_" << reported.name << "_us,"
+            << microseconds(histogram.valueAtPercentile(reported.percentile)) << "\n";
+    }
+    out << scope << "," << id << "," << name << "_max_us," << microseconds(histogram.max()) << "\n";
+}
+
+// Field of a CSV row: quoted if it holds a separator, quote or line break
+std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+void writeMetricsJson(const RunMetrics& metrics, std::ostream& out) {
+    std::streamsize precision = out.precision(6);
+    std::ios::fmtflags flags = out.flags(std::ios::fmtflags());
+
+    LatencyHistogram allFiles, allLoads;
+    for (const WorkerMetrics& worker : metrics.workers) {
+        allFiles.merge(worker.fileLatency);
+    }
+    for (const LoaderMetrics& loader : metrics.loaders) {
+        allLoads.merge(loader.loadLatency);
+    }
+
+    out << "{\n";
+    out << "  \"run\": {\"path\": " << jsonString(metrics.path) << ", \"threads\": " << metrics.threads
+        << ", \"affinity\": " << metrics.affinity << ", \"tokenizer\": " << jsonString(metrics.tokenizer)
+        << ", \"loader\": " << jsonString(metrics.loader) << ", \"files\": " << metrics.files
+        << ", \"bytes\": " << metrics.bytes << ", \"tokens\": " << metrics.tokens << ", \"terms\": "
+        << metrics.terms << "},\n";
+    out << "  \"phases\": {\"crawl_seconds\": " << metrics.crawlSeconds << ", \"sort_seconds\": "
+        << metrics.sortSeconds << ", \"load_seconds\": " << metrics.loadSeconds << ", \"queue_wait_seconds\": "
+        << metrics.queueWaitSeconds << ", \"tokenize_seconds\": " << metrics.tokenizeSeconds
+        << ", \"index_seconds\": " << metrics.indexSeconds << ", \"merge_seconds\": " << metrics.mergeSeconds
+        << ", \"total_seconds\": " << metrics.totalSeconds << "},\n";
+    out << "  \"file_latency_us\": ";
+    writeHistogramJson(allFiles, out);
+    out << ",\n  \"load_latency_us\": ";
+    writeHistogramJson(allLoads, out);
+    out << ",\n";
+
+    out << "  \"workers\": [\n";
+    for (size_t i = 0; i < metrics.workers.size(); ++i) {
+        const WorkerMetrics& worker = metrics.workers[i];
+        out << "    {\"thread\": " << i + 1 << ", \"files\": " << worker.files << ", \"bytes\": " << worker.bytes
+            << ", \"tokens\": " << worker.tokens << ", \"read_bytes\": " << worker.readBytes
+            << ", \"queue_wait_seconds\": " << worker.queueWaitSeconds
+            << ", \"tokenize_seconds\": " << worker.tokenizeSeconds << ", \"index_seconds\": "
+            << worker.indexSeconds << ", \"file_latency_us\": ";
+        writeHistogramJson(worker.fileLatency, out);
+        out << "}" << (i + 1 < metrics.workers.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+
+    out << "  \"loaders\": [\n";
+    for (size_t i = 0; i < metrics.loaders.size(); ++i) {
+        const LoaderMetrics& loader = metrics.loaders[i];
+        out << "    {\"node\": " << loader.node << ", \"files\": " << loader.files << ", \"bytes\": "
+            << loader.bytes << ", \"load_latency_us\": ";
+        writeHistogramJson(loader.loadLatency, out);
+        out << "}" << (i + 1 < metrics.loaders.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}" << std::endl;
+
+    out.precision(precision);
+    out.flags(flags);
+}
+
+void writeMetricsCsv(const RunMetrics& metrics, std::ostream& out) {
+    std::streamsize precision = out.precision(6);
+    std::ios::fmtflags flags = out.flags(std::ios::fmtflags());
+
+    out << "scope,id,metric,value\n";
+    out << "run,0,path," << csvField(metrics.path) << "\n";
+    out << "run,0,threads," << metrics.threads << "\n";
+    out << "run,0,affinity," << metrics.affinity << "\n";
+    out << "run,0,tokenizer," << csvField(metrics.tokenizer) << "\n";
+    out << "run,0,loader," << csvField(metrics.loader) << "\n";
+    out << "run,0,files," << metrics.files << "\n";
+    out << "run,0,bytes," << metrics.bytes << "\n";
+    out << "run,0,tokens," << metrics.tokens << "\n";
+    out << "run,0,terms," << metrics.terms << "\n";
+
+    out << "phase,0,crawl_seconds," << metrics.crawlSeconds << "\n";
+    out << "phase,0,sort_seconds," << metrics.sortSeconds << "\n";
+    out << "phase,0,load_seconds," << metrics.loadSeconds << "\n";
+    out << "phase,0,queue_wait_seconds," << metrics.queueWaitSeconds << "\n";
+    out << "phase,0,tokenize_seconds," << metrics.tokenizeSeconds << "\n";
+    out << "phase,0,index_seconds," << metrics.indexSeconds << "\n";
+    out << "phase,0,merge_seconds," << metrics.mergeSeconds << "\n";
+    out << "phase,0,total_seconds," << metrics.totalSeconds << "\n";
+
+    for (size_t i = 0; i < metrics.workers.size(); ++i) {
+        const WorkerMetrics& worker = metrics.workers[i];
+        int id = static_cast<int>(i) + 1;
+        out << "worker," << id << ",files," << worker.files << "\n";
+        out << "worker," << id << ",bytes," << worker.bytes << "\n";
+        out << "worker," << id << ",tokens," << worker.tokens << "\n";
+        out << "worker," << id << ",read_bytes," << worker.readBytes << "\n";
+        out << "worker," << id << ",queue_wait_seconds," << worker.queueWaitSeconds << "\n";
+        out << "worker," << id << ",tokenize_seconds," << worker.tokenizeSeconds << "\n";
+        out << "worker," << id << ",index_seconds," << worker.indexSeconds << "\n";
+        writeHistogramCsv("worker", id, "file_latency", worker.fileLatency, out);
+    }
+    for (const LoaderMetrics& loader : metrics.loaders) {
+        out << "loader," << loader.node << ",files," << loader.files << "\n";
+        out << "loader," << loader.node << ",bytes," << loader.bytes << "\n";
+        writeHistogramCsv("loader", loader.node, "load_latency", loader.loadLatency, out);
+    }
+    out.flush();
+
+    out.precision(precision);
+    out.flags(flags);
+}
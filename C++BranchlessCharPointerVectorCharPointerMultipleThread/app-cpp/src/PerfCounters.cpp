@@ -0,0 +1,123 @@
+// PerfCounters.cpp
+
+#include "PerfCounters.hpp"
+#include <cerrno>        // For errno
+#include <cstring>       // For strerror
+#include <fstream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h> // For SYS_perf_event_open
+#include <unistd.h>
+
+void PerfCounts::add(const PerfCounts& other) {
+    if (!other.any) {
+        return;
+    }
+    for (int event = 0; event < perfEventCount; ++event) {
+        values[event] += other.values[event];
+        valid[event] = (any ? valid[event] : true) && other.valid[event];
+    }
+    any = true;
+}
+
+namespace {
+
+struct EventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr EventConfig eventConfigs[perfEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},  // Last-level cache misses
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+};
+
+std::string paranoidLevel() {
+    std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+    std::string level;
+    return (file >> level) ? level : "unknown";
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    int firstErrno = 0;
+    for (int event = 0; event < perfEventCount; ++event) {
+        struct perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = eventConfigs[event].type;
+        attr.config = eventConfigs[event].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // This thread (pid 0) on any CPU it runs on
+        fds[event] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[event] == -1) {
+            firstErrno = firstErrno ? firstErrno : errno;
+        } else {
+            openCount++;
+        }
+    }
+    if (openCount == 0) {
+        openError = std::string(strerror(firstErrno)) + " (perf_event_paranoid=" + paranoidLevel() + ")";
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+void PerfCounters::start() {
+    for (int fd : fds) {
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void PerfCounters::stop() {
+    for (int fd : fds) {
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+}
+
+PerfCounts PerfCounters::read() const {
+    PerfCounts counts;
+    counts.any = true;
+    for (int event = 0; event < perfEventCount; ++event) {
+        uint64_t data[3];  // value, time enabled, time running
+        if (fds[event] == -1 || ::read(fds[event], data, sizeof(data)) != sizeof(data)) {
+            continue;
+        }
+        if (data[1] != 0 && data[2] == 0) {
+            continue;  // Enabled but never scheduled on the PMU: no count at all
+        }
+        counts.valid[event] = true;
+        // Scale up for the time the counter was multiplexed out
+        if (data[2] != 0 && data[2] < data[1]) {
+            counts.values[event] = static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+        } else {
+            counts.values[event] = data[0];
+        }
+    }
+    return counts;
+}
+
+const char* PerfCounters::eventName(int event) {
+    static const char* names[perfEventCount] = {
+        "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses", "stalled-cycles"};
+    return names[event];
+}
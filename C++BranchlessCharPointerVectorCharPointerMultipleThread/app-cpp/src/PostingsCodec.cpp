@@ -0,0 +1,197 @@
+// PostingsCodec.cpp
+
+#include "PostingsCodec.hpp"
+#include <algorithm>     // For std::min
+#include <cstring>       // For memcpy
+#include <emmintrin.h>   // SSE2 unpacking and prefix sums
+
+// Number of bits needed for the largest value
+static uint32_t bitWidth(const uint32_t* values, size_t size) {
+    uint32_t combined = 0;
+    for (size_t i = 0; i < size; ++i) {
+        combined |= values[i];
+    }
+    return combined == 0 ? 0 : 32 - __builtin_clz(combined);
+}
+
+// Pack 128 values of bits bits each into 4 * bits words, vertical 4-lane layout
+static void pack128(const uint32_t* values, uint32_t bits, uint32_t* out) {
+    if (bits == 0) {
+        return;  // Every value is 0 and takes no words
+    }
+    for (uint32_t i = 0; i < 4 * bits; ++i) {
+        out[i] = 0;
+    }
+    for (uint32_t row = 0; row < 32; ++row) {
+        uint32_t bitPosition = row * bits;
+        uint32_t word = bitPosition / 32;
+        uint32_t shift = bitPosition % 32;
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            uint32_t value = values[row * 4 + lane];
+            out[word * 4 + lane] |= value << shift;
+            if (shift + bits > 32) {
+                out[(word + 1) * 4 + lane] |= value >> (32 - shift);
+            }
+        }
+    }
+}
+
+// Unpack 128 values: each step shifts and masks four lanes at once, pulling in the
+// next packed word when a value straddles two of them
+static void unpack128(const uint32_t* in, uint32_t bits, uint32_t* out) {
+    __m128i* destination = reinterpret_cast<__m128i*>(out);
+    if (bits == 0) {
+        for (int row = 0; row < 32; ++row) {
+            _mm_storeu_si128(destination + row, _mm_setzero_si128());
+        }
+        return;
+    }
+    const __m128i* source = reinterpret_cast<const __m128i*>(in);
+    const __m128i mask = _mm_set1_epi32(bits == 32 ? -1 : static_cast<int>((1u << bits) - 1));
+    __m128i current = _mm_loadu_si128(source);
+    uint32_t word = 0;
+    uint32_t shift = 0;
+    for (int row = 0; row < 32; ++row) {
+        __m128i value = _mm_srl_epi32(current, _mm_cvtsi32_si128(static_cast<int>(shift)));
+        if (shift + bits > 32) {
+            __m128i next = _mm_loadu_si128(source + word + 1);
+            value = _mm_or_si128(value, _mm_sll_epi32(next, _mm_cvtsi32_si128(static_cast<int>(32 - shift))));
+        }
+        _mm_storeu_si128(destination + row, _mm_and_si128(value, mask));
+
+        shift += bits;
+        if (shift >= 32) {
+            shift -= 32;
+            if (++word < bits) {
+                current = _mm_loadu_si128(source + word);
+            }
+        }
+    }
+}
+
+// Turn 128 gaps into documents in place: prefix sum within each group of four, plus
+// the running total carried in from the previous group
+static void prefixSum128(uint32_t* values, uint32_t base) {
+    __m128i* data = reinterpret_cast<__m128i*>(values);
+    __m128i carry = _mm_set1_epi32(static_cast<int>(base));
+    for (int row = 0; row < 32; ++row) {
+        __m128i x = _mm_loadu_si128(data + row);
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        _mm_storeu_si128(data + row, x);
+        carry = _mm_shuffle_epi32(x, 0xFF);
+    }
+}
+
+static void addOne128(uint32_t* values) {
+    __m128i* data = reinterpret_cast<__m128i*>(values);
+    const __m128i one = _mm_set1_epi32(1);
+    for (int row = 0; row < 32; ++row) {
+        _mm_storeu_si128(data + row, _mm_add_epi32(_mm_loadu_si128(data + row), one));
+    }
+}
+
+static void putVarint(std::vector<uint8_t>& bytes, uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+static uint32_t getVarint(const uint8_t*& bytes) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (*bytes & 0x80) {
+        value |= static_cast<uint32_t>(*bytes++ & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<uint32_t>(*bytes++) << shift;
+    return value;
+}
+
+void CompressedPostings::encode(const std::vector<DocFreqPair>& postings) {
+    count = static_cast<uint32_t>(postings.size());
+    size_t blocks = (postings.size() + blockSize - 1) / blockSize;
+    words.assign(2 * blocks, 0);
+
+    uint32_t gaps[blockSize];
+    uint32_t frequencies[blockSize];
+    uint32_t previous = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+        size_t first = block * blockSize;
+        size_t length = std::min(blockSize, postings.size() - first);
+        for (size_t i = 0; i < length; ++i) {
+            uint32_t document = static_cast<uint32_t>(postings[first + i].documentNumber);
+            gaps[i] = document - previous;
+            frequencies[i] = static_cast<uint32_t>(postings[first + i].wordFrequency - 1);
+            previous = document;
+        }
+        words[2 * block] = previous;
+        words[2 * block + 1] = static_cast<uint32_t>(words.size());
+
+        if (length == blockSize) {
+            uint32_t documentBits = bitWidth(gaps, blockSize);
+            uint32_t frequencyBits = bitWidth(frequencies, blockSize);
+            words.push_back(documentBits | (frequencyBits << 8));
+            size_t offset = words.size();
+            words.resize(offset + 4 * (documentBits + frequencyBits));
+            pack128(gaps, documentBits, words.data() + offset);
+            pack128(frequencies, frequencyBits, words.data() + offset + 4 * documentBits);
+        } else {
+            // Partial last block: variable-byte gaps and frequencies, padded to whole words
+            std::vector<uint8_t> bytes;
+            for (size_t i = 0; i < length; ++i) {
+                putVarint(bytes, gaps[i]);
+                putVarint(bytes, frequencies[i]);
+            }
+            words.push_back(static_cast<uint32_t>(bytes.size()));
+            size_t offset = words.size();
+            words.resize(offset + (bytes.size() + 3) / 4);
+            memcpy(words.data() + offset, bytes.data(), bytes.size());
+        }
+    }
+    words.shrink_to_fit();
+}
+
+void CompressedPostings::assign(uint32_t count, const uint32_t* words, size_t wordCount) {
+    this->count = count;
+    this->words.assign(words, words + wordCount);
+}
+
+size_t PostingsView::decodeBlock(size_t block, uint32_t* documents, uint32_t* frequencies) const {
+    uint32_t base = block == 0 ? 0 : words[2 * (block - 1)];
+    const uint32_t* data = words + words[2 * block + 1];
+    size_t length = std::min(blockSize, count - block * blockSize);
+
+    if (length == blockSize) {
+        uint32_t documentBits = data[0] & 0xFF;
+        uint32_t frequencyBits = (data[0] >> 8) & 0xFF;
+        unpack128(data + 1, documentBits, documents);
+        prefixSum128(documents, base);
+        unpack128(data + 1 + 4 * documentBits, frequencyBits, frequencies);
+        addOne128(frequencies);
+    } else {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data + 1);
+        uint32_t document = base;
+        for (size_t i = 0; i < length; ++i) {
+            document += getVarint(bytes);
+            documents[i] = document;
+            frequencies[i] = getVarint(bytes) + 1;
+        }
+    }
+    return length;
+}
+
+void PostingsView::decode(std::vector<DocFreqPair>& postings) const {
+    uint32_t documents[blockSize];
+    uint32_t frequencies[blockSize];
+    postings.reserve(postings.size() + count);
+    for (size_t block = 0; block < blockCount(); ++block) {
+        size_t length = decodeBlock(block, documents, frequencies);
+        for (size_t i = 0; i < length; ++i) {
+            postings.push_back({static_cast<long>(documents[i]), static_cast<long>(frequencies[i])});
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// PostingsIntersection.cpp
+
+#include "PostingsIntersection.hpp"
+#include <immintrin.h>   // AVX2 intrinsics
+
+size_t seekScalar(const uint32_t* documents, size_t position, size_t count, uint32_t target) {
+    while (position < count && documents[position] < target) {
+        ++position;
+    }
+    return position;
+}
+
+// AVX2 only compares signed integers, so both sides are biased by 2^31 to compare
+// document numbers as unsigned
+__attribute__((target("avx2")))
+size_t seekAvx2(const uint32_t* documents, size_t position, size_t count, uint32_t target) {
+    const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    const __m256i biasedTarget = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(target)), bias);
+    while (position + 8 <= count) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(documents + position));
+        __m256i smaller = _mm256_cmpgt_epi32(biasedTarget, _mm256_xor_si256(block, bias));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(smaller)));
+        position += __builtin_popcount(mask);
+        if (mask != 0xFF) {
+            return position;
+        }
+    }
+    return seekScalar(documents, position, count, target);
+}
+
+BlockSeekKernel selectBlockSeekKernel(const std::string& requested) {
+    __builtin_cpu_init();
+    if (requested != "scalar" && __builtin_cpu_supports("avx2")) {
+        return seekAvx2;
+    }
+    return seekScalar;
+}
+
+// First block at or after block whose last document is >= target, or blockCount.
+// Galloping doubles the step until it passes the target, then binary searches the gap.
+static size_t skipBlocks(const PostingsView& postings, size_t block, uint32_t target, bool gallop) {
+    const size_t blocks = postings.blockCount();
+    if (!gallop) {
+        while (block < blocks && postings.blockLastDocument(block) < target) {
+            ++block;
+        }
+        return block;
+    }
+    size_t low = block;
+    size_t high = block;
+    size_t step = 1;
+    while (high < blocks && postings.blockLastDocument(high) < target) {
+        low = high + 1;
+        high += step;
+        step *= 2;
+    }
+    if (high > blocks) {
+        high = blocks;
+    }
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (postings.blockLastDocument(middle) < target) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void intersectPostings(std::vector<DocFreqPair>& candidates, const PostingsView& postings,
+                       BlockSeekKernel seek) {
+    const bool gallop = candidates.empty() || postings.size() / candidates.size() >= gallopingRatio;
+    const size_t blocks = postings.blockCount();
+
+    uint32_t documents[PostingsView::blockSize];
+    uint32_t frequencies[PostingsView::blockSize];
+    size_t decodedBlock = blocks;  // Block currently in documents/frequencies
+    size_t decodedLength = 0;
+    size_t block = 0;
+    size_t position = 0;
+    size_t kept = 0;
+
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        uint32_t document = static_cast<uint32_t>(candidates[c].documentNumber);
+
+        block = skipBlocks(postings, block, document, gallop);
+        if (block == blocks) {
+            break;  // Every remaining candidate is past the last posting
+        }
+        if (block != decodedBlock) {
+            decodedLength = postings.decodeBlock(block, documents, frequencies);
+            decodedBlock = block;
+            position = 0;
+        }
+
+        // The block's last document is >= the candidate, so the seek stops inside the block
+        position = seek(documents, position, decodedLength, document);
+        if (documents[position] == document) {
+            candidates[kept].documentNumber = document;
+            candidates[kept].wordFrequency = candidates[c].wordFrequency + frequencies[position];
+            ++kept;
+            ++position;
+            if (position == decodedLength) {
+                ++block;
+            }
+        }
+    }
+    candidates.resize(kept);
+}
@@ -1,6 +1,10 @@
 // ProcessingEngine.cpp
 
 #include "ProcessingEngine.hpp"
+#include "IoUring.hpp"
+#include "BenchmarkHarness.hpp"
+#include "CorpusGenerator.hpp"
+#include "TokenClasses.hpp"
 // #include <queue>
 #include <iostream>
 // #include <string>
@@ -14,29 +18,42 @@
 // #include <iomanip>
 // #include <sstream>
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 #include <numa.h>    // Include NUMA API
 #include <numaif.h>  // Include NUMA memory policy functions
 #include <sched.h>   // Include scheduling functions
-// #include <cstring>   // Include C string manipulation functions
+#include <cstring>   // For strnlen
 // #include <stdexcept> // For std::invalid_argument
 #include <fcntl.h>
 #include <unistd.h>  // For read, close, and other POSIX functions
+#include <cerrno>    // For errno
+#include <sys/mman.h> // For mmap, madvise, munmap
+#include <fstream>
 
 // Global mutex for synchronizing std::cout
 std::mutex cout_mutex;
 
 // Constructor for ProcessingEngine class that accepts the number of threads
-ProcessingEngine::ProcessingEngine(int numThreads, int affinityFlag) {
+ProcessingEngine::ProcessingEngine(int numThreads, int affinityFlag, const EngineOptions& options) {
     this->numThreads = numThreads;  // Initialize the numThreads member variable with the provided number of threads
     this->affinityFlag = affinityFlag;
+    this->options = options;
+
+    // Dispatch once to the tokenizer strategy, and for the branchless one to the widest
+    // kernel this CPU supports, specialized for the token character class
+    this->kernels = selectTokenizer(options.tokenizer, options.simd, options.tokenChars);
+    this->blockSeekKernel = selectBlockSeekKernel(options.simd);
 }
 
 // Load files on a specific NUMA node
 void ProcessingEngine::loadFilesOnNode(int thread_id,
                                        int node_id,
                                        const std::vector<std::pair<std::string, uintmax_t>>& files,
-                                       std::queue<FileData>& fileBuffer,
-                                       std::mutex& bufferMutex) {
+                                       BoundedQueue<FileData>& fileBuffer,
+                                       BufferPool& bufferPool,
+                                       const char charDict[256],
+                                       LoaderStats& stats) {
     // Set thread affinity to the specified NUMA node
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
@@ -49,6 +66,7 @@ void ProcessingEngine::loadFilesOnNode(int thread_id,
         std::lock_guard<std::mutex> guard(cout_mutex);
         std::cerr << "Error retrieving CPUs for node " << node_id << std::endl;
         numa_bitmask_free(cpumask);
+        fileBuffer.close();  // Still signal end of stream so workers do not wait forever
         return;
     }
 
@@ -82,70 +100,607 @@ void ProcessingEngine::loadFilesOnNode(int thread_id,
                   << " (Node " << current_node << ")" << std::endl;
     }
 
+    // Map files in mmap mode, otherwise load with io_uring if requested and
+    // available, falling back to one read() per file for whatever it did not load
+    if (options.input == "mmap") {
+        loadFilesMapped(thread_id, node_id, files, fileBuffer, charDict, stats);
+    } else if (options.loader == "uring") {
+        std::vector<std::pair<std::string, uintmax_t>> unloaded;
+        if (!loadFilesUring(thread_id, node_id, files, fileBuffer, bufferPool, charDict, stats, unloaded)) {
+            {
+                std::lock_guard<std::mutex> guard(cout_mutex);
+                std::cerr << "Loader Thread " << thread_id << " - io_uring unavailable, reading " << unloaded.size()
+                          << " files synchronously" << std::endl;
+            }
+            loadFilesSync(thread_id, node_id, unloaded, fileBuffer, bufferPool, charDict, stats);
+        }
+    } else {
+        loadFilesSync(thread_id, node_id, files, fileBuffer, bufferPool, charDict, stats);
+    }
+
+    // Tell the workers of this node that no more files are coming
+    fileBuffer.close();
+
+    std::lock_guard<std::mutex> guard(cout_mutex);
+    std::cout << "Loader Thread " << thread_id << " completed loading files on Node " << node_id << std::endl;
+    if (stats.chunkedFiles > 0) {
+        std::cout << "Loader Thread " << thread_id << " split " << stats.chunkedFiles << " large files into "
+                  << stats.totalChunks << " chunks" << std::endl;
+    }
+}
+
+// Under first-touch-by-consumer, hand whole files over unread with an untouched buffer:
+// the worker that takes the file reads it, so its pages land on that worker's node.
+// Chunked files still need their data in the loader to place boundaries, so they are
+// not deferred. Returns true if the file was handed over.
+bool ProcessingEngine::deferToConsumer(int node_id,
+                                       const std::string& filePath,
+                                       uintmax_t fileSize,
+                                       BoundedQueue<FileData>& fileBuffer,
+                                       BufferPool& bufferPool,
+                                       LoaderStats& stats) {
+    bool chunked = options.chunkBytes != 0 && fileSize > options.chunkBytes;
+    if (options.memPolicy != MemPolicy::FirstTouchByConsumer || chunked) {
+        return false;
+    }
+
+    size_t capacity;
+    char* buffer = bufferPool.acquire(bufferSizeFor(fileSize), node_id, capacity);
+    FileBuffer* sharedBuffer = new FileBuffer{buffer, capacity, node_id, false, {1}, indexStore.findDocument(filePath)};
+    std::vector<char*> bufferVector;
+    bufferVector.push_back(buffer);
+    fileBuffer.push({filePath, std::move(bufferVector), fileSize, sharedBuffer, true});
+    stats.filesLoaded++;
+    return true;
+}
+
+// Hand a fully read file to the workers, split into chunks if it is large
+void ProcessingEngine::publishFile(int node_id,
+                                   const std::string& filePath,
+                                   uintmax_t fileSize,
+                                   char* buffer,
+                                   size_t capacity,
+                                   bool mapped,
+                                   BoundedQueue<FileData>& fileBuffer,
+                                   const char charDict[256],
+                                   LoaderStats& stats) {
+    if (!mapped) {
+        buffer[fileSize] = '\0';  // Null-terminate the buffer (mappings are read-only)
+    }
+
+    // Split large files into chunks any worker can take. Each boundary is moved
+    // forward to the next delimiter so no token straddles two chunks, which also
+    // means every chunk starts in the "previous byte was a delimiter" state.
+    std::vector<std::pair<size_t, size_t>> chunks;  // (offset, length) pairs
+    size_t offset = 0;
+    do {
+        size_t end = fileSize;
+        if (options.chunkBytes != 0 && fileSize - offset > options.chunkBytes) {
+            end = offset + options.chunkBytes;
+            while (end < fileSize && charDict[(unsigned char)buffer[end]] != 0) {
+                end++;
+            }
+        }
+        chunks.emplace_back(offset, end - offset);
+        offset = end;
+    } while (offset < fileSize);
+
+    FileBuffer* sharedBuffer = new FileBuffer{buffer, capacity, node_id, mapped, {static_cast<int>(chunks.size())},
+                                              indexStore.findDocument(filePath)};
+    if (chunks.size() > 1) {
+        stats.chunkedFiles++;
+        stats.totalChunks += chunks.size();
+    }
+
+    for (const auto& [chunkOffset, chunkLength] : chunks) {
+        // Store the buffer in a vector<char*>
+        std::vector<char*> bufferVector;
+        bufferVector.push_back(buffer + chunkOffset);
+
+        // Hand the chunk to the workers, waiting here if the ring is full
+        fileBuffer.push({filePath, std::move(bufferVector), chunkLength, sharedBuffer, false});
+    }
+    stats.filesLoaded++;
+    stats.bytesLoaded += fileSize;
+}
+
+// Zero-copy loader: map each file read-only and hand the mapping to the workers.
+// The page cache backs the data, so the buffer pool and its budget are not used.
+void ProcessingEngine::loadFilesMapped(int thread_id,
+                                       int node_id,
+                                       const std::vector<std::pair<std::string, uintmax_t>>& files,
+                                       BoundedQueue<FileData>& fileBuffer,
+                                       const char charDict[256],
+                                       LoaderStats& stats) {
     for (const auto& [filePath, fileSize] : files) {
-        if (filePath.empty() || filePath.find("/.") != std::string::npos) {
+        if (filePath.empty()) {
             continue;
         }
 
-        // Open the file using open system call
+        auto loadStart = std::chrono::high_resolution_clock::now();
         int fd = open(filePath.c_str(), O_RDONLY);
+        stats.ioOperations++;
         if (fd == -1) {
             std::lock_guard<std::mutex> guard(cout_mutex);
             std::cerr << "Loader Thread " << thread_id << " - Error opening file: " << filePath << std::endl;
             continue;
         }
 
-        // Allocate a buffer to hold the file content
-        char* buffer = new char[fileSize + 1];  // +1 for null terminator
+        // Empty files cannot be mapped; they simply produce no tokens
+        char* data = nullptr;
+        if (fileSize > 0) {
+            int flags = MAP_PRIVATE | (options.mmapPopulate ? MAP_POPULATE : 0);
+            void* mapping = mmap(nullptr, fileSize, PROT_READ, flags, fd, 0);
+            stats.ioOperations++;
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                std::lock_guard<std::mutex> guard(cout_mutex);
+                std::cerr << "Loader Thread " << thread_id << " - Error mapping file: " << filePath << std::endl;
+                continue;
+            }
+            madvise(mapping, fileSize, MADV_SEQUENTIAL);
+            data = static_cast<char*>(mapping);
+        }
+        close(fd);
+        stats.ioOperations++;
+        stats.loadLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now() - loadStart).count());
 
-        // Read the file content into the buffer
-        ssize_t bytesRead = read(fd, buffer, fileSize);
-        if (bytesRead == static_cast<ssize_t>(fileSize)) {
-            buffer[fileSize] = '\0';  // Null-terminate the buffer
+        publishFile(node_id, filePath, fileSize, data, fileSize, true, fileBuffer, charDict, stats);
+    }
+}
 
-            // Advise the kernel to drop the cached pages
-            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+// Synchronous loader: open, read, fadvise and close one file at a time
+void ProcessingEngine::loadFilesSync(int thread_id,
+                                     int node_id,
+                                     const std::vector<std::pair<std::string, uintmax_t>>& files,
+                                     BoundedQueue<FileData>& fileBuffer,
+                                     BufferPool& bufferPool,
+                                     const char charDict[256],
+                                     LoaderStats& stats) {
+    for (const auto& [filePath, fileSize] : files) {
+        if (filePath.empty()) {
+            continue;
+        }
 
-            // Close the file
-            close(fd);
+        if (deferToConsumer(node_id, filePath, fileSize, fileBuffer, bufferPool, stats)) {
+            continue;
+        }
 
-            // Store the buffer in a vector<char*>
-            std::vector<char*> bufferVector;
-            bufferVector.push_back(buffer);
+        // Open the file using open system call (with O_DIRECT if requested and supported)
+        auto loadStart = std::chrono::high_resolution_clock::now();
+        bool direct;
+        int fd = openInput(filePath, direct);
+        stats.ioOperations++;
+        if (fd == -1) {
+            std::lock_guard<std::mutex> guard(cout_mutex);
+            std::cerr << "Loader Thread " << thread_id << " - Error opening file: " << filePath << std::endl;
+            continue;
+        }
 
-            {
-                std::lock_guard<std::mutex> lock(bufferMutex);
-                // Push FileData struct into the buffer queue
-                fileBuffer.push({filePath, std::move(bufferVector), fileSize});
-            }
+        // Take a recycled buffer from the pool, blocking while the memory budget is used up
+        size_t capacity;
+        char* buffer = bufferPool.acquire(bufferSizeFor(fileSize), node_id, capacity);  // +1 for null terminator
+
+        // Read the file content into the buffer
+        bool loaded = readFully(fd, buffer, fileSize, direct, stats.ioOperations);
+        if (options.directIo) {
+            (direct ? stats.directFiles : stats.bufferedFallbacks)++;
+        }
+
+        // Close the file
+        close(fd);
+        stats.ioOperations++;
+
+        if (loaded) {
+            stats.loadLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now() - loadStart).count());
+            publishFile(node_id, filePath, fileSize, buffer, capacity, false, fileBuffer, charDict, stats);
         } else {
             // If reading failed, print an error and free the allocated buffer
             std::lock_guard<std::mutex> guard(cout_mutex);
             std::cerr << "Loader Thread " << thread_id << " - Error reading file: " << filePath << std::endl;
-            delete[] buffer;
+            bufferPool.release(buffer, node_id, capacity);
+        }
+    }
+}
+
+// io_uring loader: keeps up to ioDepth files in flight, each moving through
+// openat -> read (repeated on short reads) -> fadvise + close (linked).
+// Returns false with every file in unloaded if io_uring cannot be set up or the kernel
+// lacks one of these operations, and false with the files not loaded yet if the ring
+// fails part way; the caller reads those synchronously.
+bool ProcessingEngine::loadFilesUring(int thread_id,
+                                      int node_id,
+                                      const std::vector<std::pair<std::string, uintmax_t>>& files,
+                                      BoundedQueue<FileData>& fileBuffer,
+                                      BufferPool& bufferPool,
+                                      const char charDict[256],
+                                      LoaderStats& stats,
+                                      std::vector<std::pair<std::string, uintmax_t>>& unloaded) {
+    unsigned depth = options.ioDepth > 0 ? options.ioDepth : 1;
+
+    // Between two submits a file can add an open or read plus a fadvise + close pair,
+    // so 4x depth entries keep getSqe from having to submit early
+    IoUring ring;
+    if (!ring.init(depth * 4)) {
+        unloaded = files;
+        return false;
+    }
+    for (uint8_t opcode : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_FADVISE, IORING_OP_CLOSE}) {
+        if (!ring.supportsOp(opcode)) {
+            unloaded = files;  // Kernel older than 5.6: every operation would fail with EINVAL
+            return false;
+        }
+    }
+
+    enum : uint64_t { OpOpen = 0, OpRead = 1, OpFadvise = 2, OpClose = 3 };
+    const size_t maxReadSize = size_t(1) << 30;  // sqe->len is 32 bits
+
+    // State of one file in flight
+    struct PendingFile {
+        const std::string* path;
+        uintmax_t size;
+        char* buffer;
+        size_t capacity;
+        int fd;
+        size_t bytesRead;
+        bool direct;     // Opened with O_DIRECT: reads must stay aligned
+        std::chrono::high_resolution_clock::time_point start;  // When the open was queued
+    };
+    std::vector<PendingFile> slots(depth);
+    std::vector<unsigned> freeSlots;
+    for (unsigned i = depth; i > 0; --i) {
+        freeSlots.push_back(i - 1);
+    }
+
+    // The queue helpers return false if no submission entry is free, which only happens
+    // when the kernel has stopped consuming them
+    auto queueOpen = [&](unsigned slot) -> bool {
+        PendingFile& file = slots[slot];
+        io_uring_sqe* sqe = ring.getSqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(file.path->c_str());
+        sqe->open_flags = O_RDONLY | (file.direct ? O_DIRECT : 0);
+        sqe->user_data = (uint64_t(slot) << 2) | OpOpen;
+        stats.ioOperations++;
+        return true;
+    };
+
+    auto queueRead = [&](unsigned slot) -> bool {
+        PendingFile& file = slots[slot];
+        uintmax_t length = file.size - file.bytesRead;
+        if (file.direct && file.bytesRead % directIoAlignment != 0) {
+            // A short read left us unaligned: finish this file with buffered reads
+            fcntl(file.fd, F_SETFL, fcntl(file.fd, F_GETFL) & ~O_DIRECT);
+            file.direct = false;
+        }
+        if (file.direct) {
+            // Round the unaligned tail up; the read simply stops at end of file
+            length = (length + directIoAlignment - 1) & ~uintmax_t(directIoAlignment - 1);
+        }
+        io_uring_sqe* sqe = ring.getSqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = file.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(file.buffer + file.bytesRead);
+        sqe->len = static_cast<uint32_t>(std::min<uintmax_t>(length, maxReadSize));
+        sqe->off = file.bytesRead;
+        sqe->user_data = (uint64_t(slot) << 2) | OpRead;
+        stats.ioOperations++;
+        return true;
+    };
+
+    // Queue the close of a fully read file, preceded by fadvise(DONTNEED) unless the
+    // file was read with O_DIRECT and never entered the page cache. The close is linked
+    // so the descriptor cannot be reused before the fadvise ran; it carries the fd in its
+    // user data because a failed fadvise cancels it and the fd must then be closed here.
+    // Both entries are reserved together, so a queued fadvise is always followed by its
+    // close and its link never reaches another file's entry. Returns the number of
+    // operations queued; without room for all of them both calls are made synchronously.
+    auto queueClose = [&](int fd, bool direct) -> unsigned {
+        unsigned count = direct ? 1 : 2;
+        stats.ioOperations += count;
+        io_uring_sqe* sqe[2];
+        if (!ring.getSqes(sqe, count)) {
+            if (!direct) {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            }
             close(fd);
+            return 0;
+        }
+        if (!direct) {
+            sqe[0]->opcode = IORING_OP_FADVISE;
+            sqe[0]->fd = fd;
+            sqe[0]->fadvise_advice = POSIX_FADV_DONTNEED;
+            sqe[0]->flags = IOSQE_IO_LINK;
+            sqe[0]->user_data = OpFadvise;
+        }
+        io_uring_sqe* closeSqe = sqe[count - 1];
+        closeSqe->opcode = IORING_OP_CLOSE;
+        closeSqe->fd = fd;
+        closeSqe->user_data = (uint64_t(fd) << 2) | OpClose;
+        return count;
+    };
+
+    auto failFile = [&](unsigned slot, const char* what) {
+        PendingFile& file = slots[slot];
+        {
+            std::lock_guard<std::mutex> guard(cout_mutex);
+            std::cerr << "Loader Thread " << thread_id << " - Error " << what << " file: " << *file.path << std::endl;
+        }
+        bufferPool.release(file.buffer, node_id, file.capacity);
+        freeSlots.push_back(slot);
+    };
+
+    size_t next = 0;             // Next file to submit
+    unsigned filesInFlight = 0;  // Files between openat and their last read
+    unsigned closesInFlight = 0; // fadvise/close operations not yet completed
+
+    while (next < files.size() || filesInFlight > 0 || closesInFlight > 0) {
+        // Start new files while there are free slots
+        while (!freeSlots.empty() && next < files.size()) {
+            const auto& [filePath, fileSize] = files[next];
+            if (filePath.empty()) {
+                next++;
+                continue;
+            }
+            if (deferToConsumer(node_id, filePath, fileSize, fileBuffer, bufferPool, stats)) {
+                next++;
+                continue;
+            }
+
+            // Only block on the memory budget when nothing is in flight; otherwise go
+            // reap completions first so their buffers can reach the workers
+            size_t capacity;
+            char* buffer = filesInFlight > 0 ? bufferPool.tryAcquire(bufferSizeFor(fileSize), node_id, capacity)
+                                             : bufferPool.acquire(bufferSizeFor(fileSize), node_id, capacity);
+            if (buffer == nullptr) {
+                break;
+            }
+
+            unsigned slot = freeSlots.back();
+            freeSlots.pop_back();
+            slots[slot] = {&filePath, fileSize, buffer, capacity, -1, 0, options.directIo,
+                           std::chrono::high_resolution_clock::now()};
+            next++;
+            if (!queueOpen(slot)) {
+                failFile(slot, "queueing");
+                continue;
+            }
+            filesInFlight++;
+        }
+
+        if (filesInFlight == 0 && closesInFlight == 0) {
+            continue;
+        }
+        if (ring.submitAndWait(1) < 0 && errno != EINTR) {
+            int error = errno;
+            {
+                std::lock_guard<std::mutex> guard(cout_mutex);
+                std::cerr << "Loader Thread " << thread_id << " - io_uring_enter failed: " << strerror(error)
+                          << std::endl;
+            }
+
+            // Every file in flight has one open or read outstanding. Entries the kernel never
+            // consumed are withdrawn and will not run; a withdrawn close is done here.
+            std::vector<bool> inFlight(depth, true);
+            for (unsigned slot : freeSlots) {
+                inFlight[slot] = false;
+            }
+            std::vector<bool> inKernel = inFlight;  // Open or read the kernel may still be running
+            unsigned outstanding = filesInFlight + closesInFlight;
+            std::vector<uint64_t> withdrawn;
+            ring.withdrawUnconsumed(withdrawn);
+            for (uint64_t userData : withdrawn) {
+                uint64_t op = userData & 3;
+                if (op == OpOpen || op == OpRead) {
+                    inKernel[userData >> 2] = false;
+                } else if (op == OpClose) {
+                    close(static_cast<int>(userData >> 2));
+                }
+                outstanding--;
+            }
+
+            // Wait for the rest to complete, so no read still writes into a buffer and no
+            // close still races with the descriptors closed below
+            while (outstanding > 0) {
+                uint64_t userData;
+                int result;
+                bool completed = false;
+                while (ring.popCompletion(userData, result)) {
+                    uint64_t op = userData & 3;
+                    if (op == OpOpen || op == OpRead) {
+                        inKernel[userData >> 2] = false;
+                        if (op == OpOpen && result >= 0) {
+                            slots[userData >> 2].fd = result;
+                        }
+                    } else if (op == OpClose && result == -ECANCELED) {
+                        close(static_cast<int>(userData >> 2));
+                    }
+                    outstanding--;
+                    completed = true;
+                }
+                if (!completed && ring.submitAndWait(1) < 0 && errno != EINTR) {
+                    break;  // Cannot even wait: whatever is still outstanding stays so
+                }
+            }
+
+            // Hand the files in flight back with the ones never started. A buffer that an
+            // unfinished read may still fill is abandoned rather than recycled, and its
+            // descriptor is left open.
+            size_t abandoned = 0;
+            for (unsigned slot = 0; slot < depth; ++slot) {
+                if (!inFlight[slot]) {
+                    continue;
+                }
+                PendingFile& file = slots[slot];
+                if (inKernel[slot]) {
+                    bufferPool.abandon(file.capacity);
+                    abandoned++;
+                } else {
+                    if (file.fd >= 0) {
+                        close(file.fd);
+                    }
+                    bufferPool.release(file.buffer, node_id, file.capacity);
+                }
+                unloaded.emplace_back(*file.path, file.size);
+            }
+            if (abandoned > 0) {
+                std::lock_guard<std::mutex> guard(cout_mutex);
+                std::cerr << "Loader Thread " << thread_id << " - abandoned " << abandoned
+                          << " buffers of reads that did not complete" << std::endl;
+            }
+            unloaded.insert(unloaded.end(), files.begin() + next, files.end());
+            return false;
+        }
+
+        uint64_t userData;
+        int result;
+        while (ring.popCompletion(userData, result)) {
+            uint64_t op = userData & 3;
+            unsigned slot = static_cast<unsigned>(userData >> 2);
+
+            if (op == OpFadvise || op == OpClose) {
+                if (op == OpClose && result == -ECANCELED) {
+                    close(static_cast<int>(userData >> 2));
+                }
+                closesInFlight--;
+                continue;
+            }
+
+            PendingFile& file = slots[slot];
+            if (op == OpOpen) {
+                if (result == -EINVAL && file.direct) {
+                    // Filesystem does not support O_DIRECT: reopen for buffered reads
+                    file.direct = false;
+                    stats.bufferedFallbacks++;
+                    if (!queueOpen(slot)) {
+                        failFile(slot, "queueing");
+                        filesInFlight--;
+                    }
+                    continue;
+                }
+                if (result < 0) {
+                    failFile(slot, "opening");
+                    filesInFlight--;
+                    continue;
+                }
+                file.fd = result;
+            } else {
+                if (result == -EINVAL && file.direct) {
+                    // O_DIRECT refused at read time: drop it on this descriptor and retry
+                    fcntl(file.fd, F_SETFL, fcntl(file.fd, F_GETFL) & ~O_DIRECT);
+                    file.direct = false;
+                    stats.bufferedFallbacks++;
+                    if (!queueRead(slot)) {
+                        close(file.fd);
+                        failFile(slot, "queueing");
+                        filesInFlight--;
+                    }
+                    continue;
+                }
+                if (result <= 0) {
+                    close(file.fd);
+                    failFile(slot, "reading");
+                    filesInFlight--;
+                    continue;
+                }
+                file.bytesRead += static_cast<size_t>(result);
+            }
+
+            if (file.bytesRead < file.size) {
+                if (!queueRead(slot)) {
+                    close(file.fd);
+                    failFile(slot, "queueing");
+                    filesInFlight--;
+                }
+                continue;
+            }
+
+            // Fully read: release the descriptor asynchronously and publish the file
+            closesInFlight += queueClose(file.fd, file.direct);
+            filesInFlight--;
+            if (file.direct) {
+                stats.directFiles++;
+            }
+            stats.loadLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now() - file.start).count());
+            publishFile(node_id, *file.path, file.size, file.buffer, file.capacity, false, fileBuffer, charDict, stats);
+            freeSlots.push_back(slot);
         }
     }
+    return true;
+}
 
-    std::lock_guard<std::mutex> guard(cout_mutex);
-    std::cout << "Loader Thread " << thread_id << " completed loading files on Node " << node_id << std::endl;
+// Print the I/O rates of the load phase. Under first-touch-by-consumer the counts include
+// the reads done by the workers, and the phase lasts until the last worker finished.
+void ProcessingEngine::printLoadPhase(const LoaderStats& load, double seconds) {
+    std::cout << "Load phase (" << (options.input == "mmap" ? "mmap" : options.loader) << " loader"
+              << (options.memPolicy == MemPolicy::FirstTouchByConsumer ? ", files read by the workers" : "")
+              << "): " << load.ioOperations << " I/O operations, " << load.ioOperations / seconds << " IOPS, "
+              << (static_cast<double>(load.bytesLoaded) / (1024.0 * 1024.0)) / seconds << " MB/s" << std::endl;
 }
 
-void ProcessingEngine::indexFiles(const std::string& path) {
+IndexRunStats ProcessingEngine::indexFiles(const std::string& path) {
     std::cout << "Starting indexFiles with path: " << path << std::endl;
+    IndexRunStats runStats;
+
+    // Get file paths, sizes and identities
+    auto crawlStart = std::chrono::high_resolution_clock::now();
+    std::vector<CrawledFile> crawledFiles = crawlDataset(path);
+    std::chrono::duration<double> crawlDuration = std::chrono::high_resolution_clock::now() - crawlStart;
+    std::cout << "Crawled dataset. Number of files: " << crawledFiles.size() << std::endl;
+
+    // A loaded image is read-only: copy it into memory so this build adds to it
+    auto sortStart = std::chrono::high_resolution_clock::now();
+    indexStore.materializeImage();
+
+    // Only files that are new or changed since they were indexed are loaded; indexed
+    // files that are gone from the dataset are dropped from the index
+    std::vector<std::pair<std::string, uintmax_t>> fileInfos;
+    std::unordered_set<std::string> presentPaths;
+    size_t unchangedFiles = 0;
+    uintmax_t skippedBytes = 0;
+    for (const CrawledFile& file : crawledFiles) {
+        presentPaths.insert(file.path);
+        if (indexStore.isCurrent(file.path, {file.size, file.modifiedNs, file.inode})) {
+            unchangedFiles++;
+            skippedBytes += file.size;
+        } else {
+            fileInfos.emplace_back(file.path, file.size);
+        }
+    }
+    size_t removedFiles = indexStore.removeMissingDocuments(path, presentPaths);
 
-    uintmax_t totalBytes = 0;
-    uintmax_t totalTokens = 0;
-
-    // Get file paths and sizes
-    std::vector<std::pair<std::string, uintmax_t>> fileInfos = crawlDataset(path);
-    std::cout << "Crawled dataset. Number of files: " << fileInfos.size() << std::endl;
-
-    // Sort files by size in descending order
+    // Sort files by size in descending order (then by path, so the parallel crawl still
+    // gives every document the same number from run to run)
     std::sort(fileInfos.begin(), fileInfos.end(), [](const auto& a, const auto& b) {
-        return a.second > b.second;
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
     });
 
+    // Register the documents up front so loaders only look their ids up
+    std::unordered_map<std::string, const CrawledFile*> crawledByPath;
+    for (const CrawledFile& file : crawledFiles) {
+        crawledByPath.emplace(file.path, &file);
+    }
+    size_t newFiles = 0;
+    for (const auto& [filePath, fileSize] : fileInfos) {
+        const CrawledFile& file = *crawledByPath[filePath];
+        newFiles += indexStore.findDocument(filePath) == -1;
+        indexStore.putDocument(filePath, {file.size, file.modifiedNs, file.inode});
+    }
+    std::chrono::duration<double> sortDuration = std::chrono::high_resolution_clock::now() - sortStart;
+    std::cout << "Incremental index: " << newFiles << " new, " << fileInfos.size() - newFiles << " changed, "
+              << unchangedFiles << " unchanged (" << skippedBytes << " bytes skipped), "
+              << removedFiles << " removed" << std::endl;
+
     // Determine the number of NUMA nodes
     int totalNodes = numa_max_node() + 1;
     if (totalNodes <= 0) {
@@ -153,6 +708,11 @@ void ProcessingEngine::indexFiles(const std::string& path) {
         totalNodes = 1;
     }
     std::cout << "Total NUMA nodes detected: " << totalNodes << std::endl;
+    std::cout << "Tokenizer kernel: " << kernels.name << std::endl;
+    std::cout << "Token characters: " << options.tokenChars << std::endl;
+    std::cout << "Memory policy: " << (options.memPolicy == MemPolicy::Local ? "local"
+                                       : options.memPolicy == MemPolicy::Interleave ? "interleave"
+                                       : "first-touch-by-consumer") << std::endl;
 
     // Divide the file paths among the NUMA nodes
     std::vector<std::vector<std::pair<std::string, uintmax_t>>> filesPerNode(totalNodes);
@@ -161,9 +721,32 @@ void ProcessingEngine::indexFiles(const std::string& path) {
         filesPerNode[node].emplace_back(fileInfos[i]);
     }
 
-    // Create a vector of queues to hold file data for each node
-    std::vector<std::queue<FileData>> fileBuffersPerNode(totalNodes);
-    std::vector<std::mutex> bufferMutexes(totalNodes);
+    // Create a bounded ring per node; loaders stream into it while workers consume
+    std::vector<std::unique_ptr<BoundedQueue<FileData>>> fileBuffersPerNode;
+    for (int node = 0; node < totalNodes; ++node) {
+        fileBuffersPerNode.emplace_back(new BoundedQueue<FileData>(fileQueueCapacity));
+    }
+    std::vector<LoaderStats> loaderStats(totalNodes);
+
+    // Pool of file buffers shared by loaders and workers, bounded by --max-resident-mb
+    BufferPool bufferPool(options.maxResidentBytes, options.memPolicy);
+
+    char charDict[256];  // Create a dictionary array for character classification
+    initializeCharDict(charDict);  // Initialize the character dictionary
+
+    std::vector<LocalTermTable> localTables(numThreads);     // Term tables filled by each worker
+    StatsRegistry statsRegistry(numThreads);                 // Bytes, tokens, times and steals of each worker
+    std::vector<PerfCounts> perfCounts(numThreads);          // Hardware counts of each thread's tokenize loop
+    std::vector<WorkerMetrics> workerMetrics(numThreads);    // Per-file latency of each thread
+
+    // One deque per worker; peers steal from it once their own work runs out
+    std::vector<std::unique_ptr<WorkDeque<FileData>>> workDeques;
+    for (int i = 0; i < numThreads; ++i) {
+        workDeques.emplace_back(new WorkDeque<FileData>());
+    }
+
+    // Start the timer for total execution time (loading and tokenization now overlap)
+    auto totalStart = std::chrono::high_resolution_clock::now();
 
     // Create and launch loader threads
     std::vector<std::thread> loaderThreads;
@@ -174,38 +757,13 @@ void ProcessingEngine::indexFiles(const std::string& path) {
             node + 1,
             node,
             std::cref(filesPerNode[node]),
-            std::ref(fileBuffersPerNode[node]),
-            std::ref(bufferMutexes[node])
+            std::ref(*fileBuffersPerNode[node]),
+            std::ref(bufferPool),
+            charDict,
+            std::ref(loaderStats[node])
         );
     }
 
-    // Wait for all loader threads to finish
-    for (auto& t : loaderThreads) {
-        if (t.joinable()) {
-            t.join();
-        }
-    }
-
-    // Calculate total files loaded
-    size_t totalFilesLoaded = 0;
-    for (const auto& queue : fileBuffersPerNode) {
-        totalFilesLoaded += queue.size();
-    }
-    std::cout << "All loader threads have completed. Total files loaded: " << totalFilesLoaded << std::endl;
-
-    // Remove resultPath and directory creation since we no longer write output files
-
-    char charDict[256];  // Create a dictionary array for character classification
-    initializeCharDict(charDict);  // Initialize the character dictionary
-
-    std::mutex tokenMutex, bytesMutex;  // Mutexes for synchronizing access to shared resources
-
-    std::vector<double> tokenizationTimes(numThreads, 0.0);  // Vector to store tokenization times for each thread
-    std::vector<uintmax_t> bytesProcessed(numThreads, 0);  // Vector to store bytes processed by each thread
-
-    // Start the timer for total execution time
-    auto totalStart = std::chrono::high_resolution_clock::now();
-
     std::vector<std::thread> processingThreads;  // Vector to store thread objects
     for (int i = 0; i < numThreads; ++i) {
         processingThreads.emplace_back(
@@ -213,25 +771,103 @@ void ProcessingEngine::indexFiles(const std::string& path) {
             this,
             i + 1,
             std::ref(fileBuffersPerNode),
-            std::ref(bufferMutexes),
-            std::ref(tokenMutex),
-            std::ref(bytesMutex),
+            std::ref(bufferPool),
+            std::ref(workDeques),
             charDict,
             std::ref(path),
             "",  // Empty resultPath since we don't use it
-            std::ref(totalBytes),
-            std::ref(totalTokens),
-            std::ref(tokenizationTimes),
-            std::ref(bytesProcessed)
+            std::ref(localTables),
+            std::ref(statsRegistry),
+            std::ref(perfCounts),
+            std::ref(workerMetrics)
         );
     }
 
+    // Optional progress reporter: reads the registry while the workers run
+    std::mutex progressMutex;
+    std::condition_variable progressSignal;
+    bool indexingDone = false;
+    std::thread progressThread;
+    if (options.progressSeconds > 0) {
+        uintmax_t bytesToIndex = 0;
+        for (const auto& fileInfo : fileInfos) {
+            bytesToIndex += fileInfo.second;
+        }
+        progressThread = std::thread(&ProcessingEngine::reportProgress, this, std::cref(statsRegistry), bytesToIndex,
+                                     std::ref(progressMutex), std::ref(progressSignal), std::cref(indexingDone));
+    }
+
+    // Wait for all loader threads to finish; workers keep consuming in the meantime
+    for (auto& t : loaderThreads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    std::chrono::duration<double> loadDuration = std::chrono::high_resolution_clock::now() - totalStart;
+
+    // Calculate total files loaded and the load phase I/O rates
+    LoaderStats totalLoad;
+    for (const LoaderStats& stats : loaderStats) {
+        totalLoad.filesLoaded += stats.filesLoaded;
+        totalLoad.ioOperations += stats.ioOperations;
+        totalLoad.bytesLoaded += stats.bytesLoaded;
+        totalLoad.directFiles += stats.directFiles;
+        totalLoad.bufferedFallbacks += stats.bufferedFallbacks;
+    }
+    {
+        double loadSeconds = loadDuration.count();
+        std::lock_guard<std::mutex> guard(cout_mutex);
+        std::cout << "All loader threads have completed. Total files loaded: " << totalLoad.filesLoaded
+                  << " in " << loadSeconds << " seconds" << std::endl;
+        if (options.directIo) {
+            std::cout << "Direct I/O: " << totalLoad.directFiles << " files read with O_DIRECT, "
+                      << totalLoad.bufferedFallbacks << " fell back to buffered reads" << std::endl;
+        }
+        // Under first-touch-by-consumer the workers read the files, so the load phase is
+        // only complete once they are done (reported below)
+        if (loadSeconds > 0.0 && options.memPolicy != MemPolicy::FirstTouchByConsumer) {
+            printLoadPhase(totalLoad, loadSeconds);
+        }
+    }
+
     // Join all processing threads
     for (auto& t : processingThreads) {
         if (t.joinable()) {
             t.join();
         }
     }
+    if (progressThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            indexingDone = true;
+        }
+        progressSignal.notify_one();
+        progressThread.join();
+    }
+
+    // Every worker has published its final totals
+    std::vector<WorkerStats> workerStats(numThreads);
+    WorkerStats totalStats;
+    for (int i = 0; i < numThreads; ++i) {
+        workerStats[i] = statsRegistry.snapshot(i);
+        totalStats.add(workerStats[i]);
+    }
+    if (options.memPolicy == MemPolicy::FirstTouchByConsumer) {
+        std::chrono::duration<double> readDuration = std::chrono::high_resolution_clock::now() - totalStart;
+        totalLoad.ioOperations += totalStats[StatReadOperations];
+        totalLoad.bytesLoaded += totalStats[StatReadBytes];
+        if (readDuration.count() > 0.0) {
+            printLoadPhase(totalLoad, readDuration.count());
+        }
+    }
+    uintmax_t totalTokens = totalStats[StatTokens];
+
+    // Merge phase: fold the workers' term tables into the shared index in parallel
+    auto mergeStart = std::chrono::high_resolution_clock::now();
+    mergeIndex(localTables);
+    localTables.clear();  // Release the worker arenas; the index holds its own copies of the terms
+    indexStore.clearRetiredDocuments();
+    std::chrono::duration<double> mergeDuration = std::chrono::high_resolution_clock::now() - mergeStart;
 
     // End the total execution time
     auto totalEnd = std::chrono::high_resolution_clock::now();
@@ -241,8 +877,8 @@ void ProcessingEngine::indexFiles(const std::string& path) {
     int longestThreadId = 0;
     double longestTime = 0.0;
     for (int i = 0; i < numThreads; ++i) {
-        if (tokenizationTimes[i] > longestTime) {
-            longestTime = tokenizationTimes[i];
+        if (workerStats[i].seconds(StatTokenizeNs) > longestTime) {
+            longestTime = workerStats[i].seconds(StatTokenizeNs);
             longestThreadId = i + 1;
         }
     }
@@ -251,69 +887,223 @@ void ProcessingEngine::indexFiles(const std::string& path) {
     std::cout << std::fixed << std::setprecision(4);
 
     for (int i = 0; i < numThreads; ++i) {
-        std::cout << "Thread " << (i + 1) << " tokenization time: " << tokenizationTimes[i] << " seconds" << std::endl;
-        std::cout << "Thread " << (i + 1) << " processed " << bytesProcessed[i] << " bytes" << std::endl;
+        std::cout << "Thread " << (i + 1) << " tokenization time: " << workerStats[i].seconds(StatTokenizeNs) << " seconds" << std::endl;
+        std::cout << "Thread " << (i + 1) << " indexing time: " << workerStats[i].seconds(StatIndexNs) << " seconds" << std::endl;
+        std::cout << "Thread " << (i + 1) << " processed " << workerStats[i][StatBytes] << " bytes" << std::endl;
+        std::cout << "Thread " << (i + 1) << " stole " << workerStats[i][StatLocalSteals] << " files from its node and "
+                  << workerStats[i][StatRemoteSteals] << " from remote nodes" << std::endl;
     }
 
     std::cout << "Thread " << longestThreadId << " took the longest time for tokenization: " << longestTime << " seconds" << std::endl;
 
-    std::cout << "Total execution time (create and join threads): " << totalTime << " seconds" << std::endl;
-
-    uintmax_t totalProcessedBytes = 0;
-    for (int i = 0; i < numThreads; ++i) {
-        totalProcessedBytes += bytesProcessed[i];
+    if (options.perfCounters) {
+        reportPerfCounts(perfCounts, statsRegistry);
     }
 
+    std::cout << "Total execution time (load, create and join threads): " << totalTime << " seconds" << std::endl;
+
+    uintmax_t totalProcessedBytes = totalStats[StatBytes];
+
     std::cout << "Completed indexing " << totalProcessedBytes << " bytes of data" << std::endl;
     std::cout << "Completed indexing " << totalTokens << " tokens" << std::endl;
+    std::cout << "Skipped " << skippedBytes << " bytes of unchanged files" << std::endl;
 
     // Calculate and print average throughput
     double throughput_MB_per_s = (static_cast<double>(totalProcessedBytes) / (1024.0 * 1024.0)) / totalTime;
     std::cout << "Average Throughput: " << throughput_MB_per_s << " MB/s" << std::endl;
 
-    // Remove code related to destination folder size and deletion
-}
+    // Index build throughput over the time workers spent tokenizing and counting terms
+    // (summed over threads, so this is per-thread throughput)
+    double buildTime = totalStats.seconds(StatTokenizeNs) + totalStats.seconds(StatIndexNs);
+    std::cout << "Index contains " << indexStore.termCount() << " terms in " << indexStore.documentCount()
+              << " documents" << std::endl;
+    // Term storage: term bytes in the arenas plus dictionary slots, per distinct term.
+    // Reserved arena bytes are shown apart: the first block of each partition would
+    // dominate the per-term figure of a small index.
+    size_t arenaBytesUsed, arenaBytesReserved, tableBytes;
+    indexStore.termStorageBytes(arenaBytesUsed, arenaBytesReserved, tableBytes);
+    size_t uniqueTerms = indexStore.termCount();
+    std::cout << "Term dictionary: " << arenaBytesUsed << " arena bytes used (" << arenaBytesReserved
+              << " reserved), " << tableBytes << " table bytes, "
+              << (uniqueTerms ? static_cast<double>(arenaBytesUsed + tableBytes) / uniqueTerms : 0.0)
+              << " bytes per unique term" << std::endl;
+    // Compressed postings size and how fast the search path can decode them
+    size_t postingCount, postingBytes;
+    indexStore.postingsStorage(postingCount, postingBytes);
+    auto decodeStart = std::chrono::high_resolution_clock::now();
+    size_t decodedPostings = indexStore.decodeAllPostings();
+    std::chrono::duration<double> decodeDuration = std::chrono::high_resolution_clock::now() - decodeStart;
+    std::cout << "Compressed postings: " << postingCount << " postings in " << postingBytes << " bytes ("
+              << (postingCount ? static_cast<double>(postingBytes) / postingCount : 0.0) << " bytes per posting)" << std::endl;
+    if (decodeDuration.count() > 0.0) {
+        std::cout << "Postings decode throughput: " << decodedPostings / decodeDuration.count() / 1e6
+                  << " million postings/s" << std::endl;
+    }
+    std::cout << "Index merge time: " << mergeDuration.count() << " seconds (" << indexPartitionCount
+              << " partitions, " << numThreads << " threads)" << std::endl;
+
+    // Partition sizes show how evenly the term hash spreads the merge work
+    size_t smallestPartition = SIZE_MAX, largestPartition = 0;
+    std::cout << "Index partition sizes (terms):";
+    for (size_t p = 0; p < indexPartitionCount; ++p) {
+        size_t terms = indexStore.partitionTermCount(p);
+        smallestPartition = std::min(smallestPartition, terms);
+        largestPartition = std::max(largestPartition, terms);
+        std::cout << " " << terms;
+    }
+    std::cout << std::endl;
+    std::cout << "Index partition sizes: min " << smallestPartition << ", max " << largestPartition
+              << ", mean " << static_cast<double>(indexStore.termCount()) / indexPartitionCount << std::endl;
+    if (buildTime > 0.0) {
+        std::cout << "Index build throughput: " << static_cast<double>(totalTokens) / buildTime << " tokens/s, "
+                  << (static_cast<double>(totalProcessedBytes) / (1024.0 * 1024.0)) / buildTime
+                  << " MB/s per thread" << std::endl;
+    }
+
+    // Report where the tokenized bytes were placed relative to the worker that read them
+    if (options.verifyPlacement) {
+        uintmax_t totalLocal = totalStats[StatLocalMemoryBytes];
+        uintmax_t totalRemote = totalStats[StatRemoteMemoryBytes];
+        uintmax_t totalPlaced = totalLocal + totalRemote;
+        double localFraction = totalPlaced ? static_cast<double>(totalLocal) / totalPlaced : 0.0;
+        std::cout << "Memory placement: " << totalLocal << " bytes tokenized from local memory, "
+                  << totalRemote << " from remote memory (" << localFraction * 100.0 << "% local)" << std::endl;
+    }
 
+    // Report the high-water mark of loaded file buffers to help size hosts
+    // (mapped input lives in the page cache and bypasses the pool)
+    std::cout << "Peak resident buffer bytes: " << bufferPool.peakResidentBytes();
+    if (bufferPool.budgetBytes() != 0) {
+        std::cout << " (budget " << bufferPool.budgetBytes() << " bytes)";
+    }
+    std::cout << std::endl;
+
+    // Phase breakdown; parallel phases are summed over the threads that ran them
+    double queueWaitTime = totalStats.seconds(StatQueueWaitNs);
+    double tokenizeTime = totalStats.seconds(StatTokenizeNs);
+    double indexTime = totalStats.seconds(StatIndexNs);
+    std::cout << "Phase times: crawl " << crawlDuration.count() << " s, sort " << sortDuration.count()
+              << " s, load " << loadDuration.count() << " s, queue wait " << queueWaitTime << " thread-s, tokenize "
+              << tokenizeTime << " thread-s, index " << indexTime << " thread-s, merge " << mergeDuration.count()
+              << " s" << std::endl;
+
+    if (!options.metrics.empty()) {
+        RunMetrics metrics;
+        metrics.path = path;
+        metrics.threads = numThreads;
+        metrics.affinity = affinityFlag;
+        metrics.tokenizer = kernels.name;
+        metrics.loader = options.input == "mmap" ? "mmap" : options.loader;
+        metrics.files = fileInfos.size();
+        metrics.bytes = totalProcessedBytes;
+        metrics.tokens = totalTokens;
+        metrics.terms = indexStore.termCount();
+        metrics.crawlSeconds = crawlDuration.count();
+        metrics.sortSeconds = sortDuration.count();
+        metrics.loadSeconds = loadDuration.count();
+        metrics.queueWaitSeconds = queueWaitTime;
+        metrics.tokenizeSeconds = tokenizeTime;
+        metrics.indexSeconds = indexTime;
+        metrics.mergeSeconds = mergeDuration.count();
+        metrics.totalSeconds = totalTime;
+        for (int i = 0; i < numThreads; ++i) {
+            workerMetrics[i].files = workerStats[i][StatFiles];
+            workerMetrics[i].bytes = workerStats[i][StatBytes];
+            workerMetrics[i].tokens = workerStats[i][StatTokens];
+            workerMetrics[i].readBytes = workerStats[i][StatReadBytes];
+            workerMetrics[i].queueWaitSeconds = workerStats[i].seconds(StatQueueWaitNs);
+            workerMetrics[i].tokenizeSeconds = workerStats[i].seconds(StatTokenizeNs);
+            workerMetrics[i].indexSeconds = workerStats[i].seconds(StatIndexNs);
+        }
+        metrics.workers = std::move(workerMetrics);
+        for (int node = 0; node < totalNodes; ++node) {
+            LoaderMetrics loader;
+            loader.node = node;
+            loader.files = loaderStats[node].filesLoaded;
+            loader.bytes = loaderStats[node].bytesLoaded;
+            loader.loadLatency = loaderStats[node].loadLatency;
+            metrics.loaders.push_back(loader);
+        }
+        writeMetrics(metrics);
+    }
 
-// Tokenization function remains unchanged
-std::vector<char*> ProcessingEngine::tokenize(char* buffer, size_t fileSize, char charDict[256]) {
-    char* bufferData = buffer;
-    std::vector<char*> tokens;
+    runStats.files = fileInfos.size();
+    runStats.bytes = totalProcessedBytes;
+    runStats.tokens = totalTokens;
+    runStats.terms = indexStore.termCount();
+    runStats.crawlSeconds = crawlDuration.count();
+    runStats.mergeSeconds = mergeDuration.count();
+    runStats.totalSeconds = totalTime;
+    runStats.throughputMBps = throughput_MB_per_s;
+    return runStats;
+}
 
-    char charPrev = charDict[(unsigned char)bufferData[0]];
-    buffer[0] &= charPrev;
 
-    if (charPrev == ~0) {
-        tokens.push_back(&buffer[0]);
-    }
+// Tokenization function: masks delimiters in place and stores pointers to token starts
+// in tokens. The caller keeps tokens across files, so once it has grown to the largest
+// file's token count tokenizing allocates nothing.
+void ProcessingEngine::tokenize(char* buffer, size_t fileSize, char charDict[256], std::vector<char*>& tokens) {
+    tokens.clear();
+    kernels.tokenize(buffer, fileSize, charDict, nibbleTables, tokens);
+}
 
-    for (size_t i = 1; i < fileSize; i++) {
-        char charNext = charDict[(unsigned char)bufferData[i]];
-        buffer[i] = bufferData[i] & charNext;
+// Read-only tokenization for mapped input: the buffer is left untouched and each
+// token is stored as a (start, length) span in the caller's reused spans
+void ProcessingEngine::tokenizeSpans(const char* buffer, size_t fileSize, char charDict[256],
+                                     std::vector<TokenSpan>& spans) {
+    spans.clear();
+    kernels.tokenizeSpans(buffer, fileSize, charDict, nibbleTables, spans);
+}
 
-        if (charPrev == 0 && charNext == ~0) {
-            tokens.push_back(&buffer[i]);
-        }
+// Count in-place tokens into the worker's table. Delimiters were zeroed by the tokenizer,
+// so a token ends at the next null byte; the search is bounded by the end of this chunk
+// because the byte after it belongs to the next chunk, which another worker may be
+// masking right now.
+void ProcessingEngine::countTerms(const std::vector<char*>& tokens, const char* end, long documentNumber,
+                                  LocalTermTable& localTable) {
+    for (const char* token : tokens) {
+        localTable.addTerm(token, strnlen(token, static_cast<size_t>(end - token)), documentNumber);
+    }
+}
 
-        charPrev = charNext;
+// Count read-only token spans (mapped input)
+void ProcessingEngine::countTerms(const std::vector<TokenSpan>& spans, long documentNumber,
+                                  LocalTermTable& localTable) {
+    for (const TokenSpan& span : spans) {
+        localTable.addTerm(span.start, span.length, documentNumber);
     }
+}
 
-    return tokens;
+// Merge the workers' tables into the index. Each thread claims whole partitions, so
+// no two threads ever touch the same part of the index and no term lock is needed.
+void ProcessingEngine::mergeIndex(std::vector<LocalTermTable>& localTables) {
+    std::atomic<size_t> nextPartition{0};
+    std::vector<std::thread> mergeThreads;
+    for (int i = 0; i < numThreads; ++i) {
+        mergeThreads.emplace_back([&]() {
+            size_t partition;
+            while ((partition = nextPartition.fetch_add(1, std::memory_order_relaxed)) < indexPartitionCount) {
+                indexStore.mergePartition(partition, localTables);
+            }
+        });
+    }
+    for (auto& t : mergeThreads) {
+        t.join();
+    }
 }
 
 // Worker function for threads with manual node affinity option
 void ProcessingEngine::processFile(int thread_id,
-                                   std::vector<std::queue<FileData>>& fileBuffersPerNode,
-                                   std::vector<std::mutex>& bufferMutexes,
-                                   std::mutex& tokenMutex,
-                                   std::mutex& bytesMutex,
+                                   std::vector<std::unique_ptr<BoundedQueue<FileData>>>& fileBuffersPerNode,
+                                   BufferPool& bufferPool,
+                                   std::vector<std::unique_ptr<WorkDeque<FileData>>>& workDeques,
                                    char charDict[256],
                                    const std::string& path,
                                    const std::string& resultPath,
-                                   uintmax_t& totalBytes,
-                                   uintmax_t& totalTokens,
-                                   std::vector<double>& tokenizationTimes,
-                                   std::vector<uintmax_t>& bytesProcessed) {
+                                   std::vector<LocalTermTable>& localTables,
+                                   StatsRegistry& statsRegistry,
+                                   std::vector<PerfCounts>& perfCounts,
+                                   std::vector<WorkerMetrics>& workerMetrics) {
 
     // Determine the number of NUMA nodes
     int totalNodes = numa_max_node() + 1; // numa_max_node() returns the highest node number
@@ -370,115 +1160,360 @@ void ProcessingEngine::processFile(int thread_id,
         }
     }
 
-    double threadTokenizationTime = 0.0;
-    while (true) {
-       
+    // Node whose ring this worker drains first (rings exist only for loading nodes)
+    int queueNode = (thread_id - 1) % static_cast<int>(fileBuffersPerNode.size());
 
-        FileData fileData;
-        bool foundWork = false;
+    // Running totals of this thread, published to its registry slot after every file
+    WorkerStats stats;
 
-        // Try to get work from the assigned node
-        {
-            std::lock_guard<std::mutex> lock(bufferMutexes[node]);
-            if (!fileBuffersPerNode[node].empty()) {
-                fileData = fileBuffersPerNode[node].front();
-                fileBuffersPerNode[node].pop();
-                foundWork = true;
-            }
-        }
+    // Counters of this thread, enabled only while it tokenizes
+    std::unique_ptr<PerfCounters> counters;
+    if (options.perfCounters) {
+        counters.reset(new PerfCounters());
+    }
+    LatencyHistogram& fileLatency = workerMetrics[thread_id - 1].fileLatency;
 
-        // // If no work found, try to get work from other nodes
-        // if (!foundWork) {
-        //     for (int i = 0; i < totalNodes; ++i) {
-        //         if (i == node) continue; // Skip assigned node (already checked)
-        //         std::lock_guard<std::mutex> lock(bufferMutexes[i]);
-        //         if (!fileBuffersPerNode[i].empty()) {
-        //             fileData = fileBuffersPerNode[i].front();
-        //             fileBuffersPerNode[i].pop();
-        //             foundWork = true;
-        //             break; // Exit the loop as we found work
-        //         }
-        //     }
-        // }
-
-        if (!foundWork) {
-            // No work found in any buffer, exit the loop
+    // Token buffers reused for every file this thread processes
+    std::vector<char*> tokens;
+    std::vector<TokenSpan> spans;
+    while (true) {
+        FileData fileData;
+
+        // Take work from this thread's deque, its node's ring or a peer; stop once
+        // every ring is closed and drained and no peer has anything left to steal
+        auto waitStart = std::chrono::high_resolution_clock::now();
+        bool found = findWork(thread_id, queueNode, fileBuffersPerNode, workDeques, fileData,
+                              stats[StatLocalSteals], stats[StatRemoteSteals]);
+        stats[StatQueueWaitNs] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now() - waitStart).count();
+        if (!found) {
             break;
         }
 
         uintmax_t fileSize = fileData.size;
-
-        {
-            std::lock_guard<std::mutex> lock(bytesMutex);
-            totalBytes += fileSize;
+        char* buffer = fileData.content[0]; // Get the buffer pointer
+        FileBuffer* sharedBuffer = fileData.buffer;
+
+        if (fileData.readByConsumer || options.memPolicy == MemPolicy::FirstTouchByConsumer) {
+            int cpuNode = numa_node_of_cpu(sched_getcpu());
+
+            if (fileData.readByConsumer) {
+                // First touch of the untouched buffer happens here, on this worker's node
+                bool direct;
+                int fd = openInput(fileData.path, direct);
+                size_t readCalls = 0;
+                bool loaded = fd != -1 && readFully(fd, buffer, fileSize, direct, readCalls);
+                if (fd != -1) {
+                    close(fd);
+                }
+                stats[StatReadOperations] += (fd != -1 ? 2 : 1) + readCalls;
+                stats[StatReadBytes] += loaded ? fileSize : 0;
+                if (!loaded) {
+                    {
+                        std::lock_guard<std::mutex> guard(cout_mutex);
+                        std::cerr << "Thread " << thread_id << " - Error reading file: " << fileData.path << std::endl;
+                    }
+                    bufferPool.release(sharedBuffer->data, sharedBuffer->node, sharedBuffer->capacity);
+                    delete sharedBuffer;
+                    continue;
+                }
+                buffer[fileSize] = '\0';
+            } else if (options.memPolicy == MemPolicy::FirstTouchByConsumer && !sharedBuffer->mapped) {
+                // Chunks were filled by the loader: move their pages to the consuming node
+                migratePages(buffer, fileSize, cpuNode);
+            }
         }
-        bytesProcessed[thread_id - 1] += fileSize;
 
-        char* buffer = fileData.content[0]; // Get the buffer pointer
+        stats[StatBytes] += fileSize;
 
         // Tokenize the buffer directly
         auto tokenStart = std::chrono::high_resolution_clock::now();
+        if (counters) {
+            counters->start();
+        }
 
-        // Call the tokenize function
-        std::vector<char*> tokens = tokenize(buffer, fileSize, charDict);
+        // Call the tokenize function; mapped input is read-only, so it gets token spans
+        size_t tokenCount;
+        if (sharedBuffer->mapped) {
+            tokenizeSpans(buffer, fileSize, charDict, spans);
+            tokenCount = spans.size();
+        } else {
+            tokenize(buffer, fileSize, charDict, tokens);
+            tokenCount = tokens.size();
+        }
 
+        if (counters) {
+            counters->stop();
+        }
         auto tokenEnd = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> tokenDuration = tokenEnd - tokenStart;
-        threadTokenizationTime += tokenDuration.count();
+        stats[StatTokenizeNs] += std::chrono::duration_cast<std::chrono::nanoseconds>(tokenEnd - tokenStart).count();
 
-        {
-            std::lock_guard<std::mutex> lock(tokenMutex);
-            totalTokens += tokens.size();
+        // Count the terms of this file (or chunk) into this thread's own table; it is
+        // merged into the shared index once all workers are done
+        if (sharedBuffer->mapped) {
+            countTerms(spans, sharedBuffer->documentNumber, localTables[thread_id - 1]);
+        } else {
+            countTerms(tokens, buffer + fileSize, sharedBuffer->documentNumber, localTables[thread_id - 1]);
         }
 
-        
+        auto indexEnd = std::chrono::high_resolution_clock::now();
+        stats[StatIndexNs] += std::chrono::duration_cast<std::chrono::nanoseconds>(indexEnd - tokenEnd).count();
+        fileLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(indexEnd - tokenStart).count());
+        stats[StatFiles]++;
+        stats[StatTokens] += tokenCount;
+
+        // Check where the pages just tokenized live (after tokenizing, so mapped pages are resident)
+        if (options.verifyPlacement) {
+            measurePlacement(buffer, fileSize, numa_node_of_cpu(sched_getcpu()),
+                             stats[StatLocalMemoryBytes], stats[StatRemoteMemoryBytes]);
+        }
+
+        // Return the buffer to the pool once every chunk of the file is tokenized
+        if (sharedBuffer->pendingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (sharedBuffer->mapped) {
+                if (sharedBuffer->data != nullptr) {
+                    munmap(sharedBuffer->data, sharedBuffer->capacity);
+                }
+            } else {
+                bufferPool.release(sharedBuffer->data, sharedBuffer->node, sharedBuffer->capacity);
+            }
+            delete sharedBuffer;
+        }
 
-        // Clean up allocated memory
-        delete[] buffer;
+        statsRegistry.publish(thread_id - 1, stats);
+    }
+    statsRegistry.publish(thread_id - 1, stats);  // Queue wait of the final, empty search
 
+    if (counters && counters->available()) {
+        perfCounts[thread_id - 1] = counters->read();
+    }
+}
 
-        // Update tokenization time for the thread
-        tokenizationTimes[thread_id - 1] = threadTokenizationTime;
+// Open a file for loading, with O_DIRECT when --direct-io is set. Filesystems that
+// refuse O_DIRECT (tmpfs, some FUSE mounts) get a plain buffered descriptor instead.
+int ProcessingEngine::openInput(const std::string& filePath, bool& direct) {
+    direct = false;
+    if (options.directIo) {
+        int fd = open(filePath.c_str(), O_RDONLY | O_DIRECT);
+        if (fd != -1 || errno != EINVAL) {
+            direct = fd != -1;
+            return fd;
+        }
     }
+    return open(filePath.c_str(), O_RDONLY);
 }
 
-// Initialize the character dictionary for tokenization
-void ProcessingEngine::initializeCharDict(char charDict[256]) {
-    for (int i = 0; i < 256; i++) {
-        charDict[i] = ~0;  // Initialize the dictionary to mark all characters as non-delimiters
+// Buffer size needed for a file: room for the null terminator, rounded up to whole
+// aligned blocks for O_DIRECT because those reads always transfer full blocks
+size_t ProcessingEngine::bufferSizeFor(uintmax_t fileSize) const {
+    if (!options.directIo) {
+        return fileSize + 1;
     }
-    for (int i = 0; i < 256; i++) {
-        if (!isalnum(static_cast<char>(i))) {
-            charDict[i] = 0;  // Mark non-alphanumeric characters as delimiters
+    return (fileSize + 1 + directIoAlignment - 1) & ~(directIoAlignment - 1);
+}
+
+// Read size bytes from fd into buffer; large files can need several reads.
+// With O_DIRECT every read starts at an aligned offset and asks for whole blocks;
+// the last one stops at end of file, which handles an unaligned tail. If a short
+// read leaves the offset unaligned, or the kernel refuses the direct read, the
+// descriptor drops O_DIRECT and the rest is read through the page cache.
+bool ProcessingEngine::readFully(int fd, char* buffer, size_t size, bool& direct, size_t& readCalls) {
+    size_t bytesRead = 0;
+    while (bytesRead < size) {
+        if (direct && bytesRead % directIoAlignment != 0) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            direct = false;
+        }
+        size_t length = size - bytesRead;
+        if (direct) {
+            length = (length + directIoAlignment - 1) & ~(directIoAlignment - 1);
+        }
+
+        ssize_t count = read(fd, buffer + bytesRead, length);
+        readCalls++;
+        if (count < 0 && direct && errno == EINVAL) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            direct = false;
+            continue;
+        }
+        if (count <= 0) {
+            return false;
         }
+        bytesRead += static_cast<size_t>(count);
     }
+
+    // Advise the kernel to drop the cached pages (direct reads never populated them)
+    if (!direct) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        readCalls++;
+    }
+    return true;
 }
 
-// Method to crawl the dataset and list all file paths and sizes
-std::vector<std::pair<std::string, uintmax_t>> ProcessingEngine::crawlDataset(const std::string& path) {
-    std::vector<std::pair<std::string, uintmax_t>> fileInfos;  // Vector to store file paths and sizes
-    try {
-        crawl(path, fileInfos);  // Recursively crawl the directory to collect file paths and sizes
-    } catch(const std::exception& e) {
-        std::cerr << "Filesystem error: " << e.what() << std::endl;  // Handle filesystem errors
+// Collect the addresses of the pages spanned by [data, data + size)
+static std::vector<void*> pagesOf(char* data, size_t size) {
+    const uintptr_t pageSize = 4096;
+    std::vector<void*> pages;
+    uintptr_t first = reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+    for (uintptr_t page = first; page < end; page += pageSize) {
+        pages.push_back(reinterpret_cast<void*>(page));
     }
-    return fileInfos;  // Return the vector of file paths and sizes
+    return pages;
 }
 
-// Helper method to recursively crawl directories and collect file paths and sizes
-void ProcessingEngine::crawl(const std::filesystem::path& folder, std::vector<std::pair<std::string, uintmax_t>>& fileInfos) {
-    for (const auto& entry : std::filesystem::recursive_directory_iterator(folder)) {
-        if (entry.is_regular_file()) {
-            try {
-                uintmax_t fileSize = entry.file_size();
-                fileInfos.emplace_back(entry.path().string(), fileSize);  // Add file path and size to the vector
-            } catch (const std::filesystem::filesystem_error& e) {
-                std::cerr << "Error getting size of file: " << entry.path() << " - " << e.what() << std::endl;
+// Move the pages of a buffer range to the given node
+void ProcessingEngine::migratePages(char* data, size_t size, int node) {
+    std::vector<void*> pages = pagesOf(data, size);
+    if (pages.empty()) {
+        return;
+    }
+    std::vector<int> nodes(pages.size(), node);
+    std::vector<int> status(pages.size());
+    numa_move_pages(0, pages.size(), pages.data(), nodes.data(), status.data(), MPOL_MF_MOVE);
+}
+
+// Query with move_pages which node holds each page of a buffer range and attribute
+// the bytes of that range to local or remote memory relative to the given node
+void ProcessingEngine::measurePlacement(char* data, size_t size, int node,
+                                        uintmax_t& localBytes, uintmax_t& remoteBytes) {
+    const uintptr_t pageSize = 4096;
+    std::vector<void*> pages = pagesOf(data, size);
+    if (pages.empty()) {
+        return;
+    }
+    std::vector<int> status(pages.size());
+    if (numa_move_pages(0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+        return;
+    }
+
+    uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    uintptr_t end = begin + size;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        uintptr_t pageStart = std::max(reinterpret_cast<uintptr_t>(pages[i]), begin);
+        uintptr_t pageEnd = std::min(reinterpret_cast<uintptr_t>(pages[i]) + pageSize, end);
+        if (status[i] < 0) {
+            continue;  // Page not resident (e.g. -ENOENT), not attributed to any node
+        }
+        if (status[i] == node) {
+            localBytes += pageEnd - pageStart;
+        } else {
+            remoteBytes += pageEnd - pageStart;
+        }
+    }
+}
+
+// Find the next file for a worker, in order of locality:
+//   1. the worker's own deque
+//   2. a batch from its node's ring, moved into its deque
+//   3. half of the deque of a peer pinned to the same node
+//   4. the rings and then the peer deques of remote nodes
+// Returns false when all rings are closed and drained and every deque is empty.
+bool ProcessingEngine::findWork(int thread_id,
+                                int node,
+                                std::vector<std::unique_ptr<BoundedQueue<FileData>>>& fileBuffersPerNode,
+                                std::vector<std::unique_ptr<WorkDeque<FileData>>>& workDeques,
+                                FileData& fileData,
+                                uint64_t& localSteals,
+                                uint64_t& remoteSteals) {
+    int totalNodes = static_cast<int>(fileBuffersPerNode.size());
+    int totalWorkers = static_cast<int>(workDeques.size());
+    int self = thread_id - 1;
+    WorkDeque<FileData>& ownDeque = *workDeques[self];
+    std::vector<FileData> stolen;
+
+    while (true) {
+        if (ownDeque.pop(fileData)) {
+            return true;
+        }
+
+        // Refill from the node's ring: keep one file, queue the rest where peers can steal it
+        if (fileBuffersPerNode[node]->tryPop(fileData)) {
+            FileData extra;
+            for (int i = 1; i < refillBatchSize && fileBuffersPerNode[node]->tryPop(extra); ++i) {
+                ownDeque.push(std::move(extra));
             }
+            return true;
         }
+
+        // Steal from peers on the same node, starting with the next worker id
+        for (int offset = 1; offset < totalWorkers; ++offset) {
+            int peer = (self + offset) % totalWorkers;
+            if (peer % totalNodes != node) {
+                continue;
+            }
+            if (workDeques[peer]->stealHalf(stolen) > 0) {
+                localSteals += stolen.size();
+                fileData = std::move(stolen.front());
+                for (size_t i = 1; i < stolen.size(); ++i) {
+                    ownDeque.push(std::move(stolen[i]));
+                }
+                return true;
+            }
+        }
+
+        // Steal from remote nodes: take straight from their rings first, then their workers
+        for (int offset = 1; offset < totalNodes; ++offset) {
+            int remoteNode = (node + offset) % totalNodes;
+            if (fileBuffersPerNode[remoteNode]->tryPop(fileData)) {
+                remoteSteals++;
+                return true;
+            }
+        }
+        for (int offset = 1; offset < totalWorkers; ++offset) {
+            int peer = (self + offset) % totalWorkers;
+            if (peer % totalNodes == node) {
+                continue;
+            }
+            if (workDeques[peer]->stealHalf(stolen) > 0) {
+                remoteSteals += stolen.size();
+                fileData = std::move(stolen.front());
+                for (size_t i = 1; i < stolen.size(); ++i) {
+                    ownDeque.push(std::move(stolen[i]));
+                }
+                return true;
+            }
+        }
+
+        // Nothing found: finished if loaders are done and no deque holds work,
+        // otherwise wait for loaders to produce more
+        bool allDrained = true;
+        for (int n = 0; n < totalNodes && allDrained; ++n) {
+            allDrained = fileBuffersPerNode[n]->isDrained();
+        }
+        for (int w = 0; w < totalWorkers && allDrained; ++w) {
+            allDrained = workDeques[w]->empty();
+        }
+        if (allDrained) {
+            return false;
+        }
+        std::this_thread::yield();
     }
 }
 
+// Initialize the character dictionary for tokenization from the token character class.
+// The kernels of a fixed class use their compile-time copy of it; the loaders, the regex
+// strategy and custom classes read this one.
+void ProcessingEngine::initializeCharDict(char charDict[256]) {
+    buildCharTable(options.tokenChars, charDict);
+
+    // Derive the shuffle tables used by the vectorized kernels
+    nibbleTables = buildNibbleTables(charDict);
+}
+
+// Method to crawl the dataset and list all files with their sizes, modification times
+// and inodes. Directories are scanned in parallel by the engine's threads; hidden
+// entries are pruned while crawling.
+std::vector<CrawledFile> ProcessingEngine::crawlDataset(const std::string& path) {
+    auto crawlStart = std::chrono::high_resolution_clock::now();
+    DirectoryCrawler crawler(numThreads);
+    std::vector<CrawledFile> fileInfos = crawler.crawl(path);
+    std::chrono::duration<double> crawlDuration = std::chrono::high_resolution_clock::now() - crawlStart;
+    std::cout << "Crawl time: " << crawlDuration.count() << " seconds (" << crawler.directoriesScanned()
+              << " directories, " << numThreads << " threads)" << std::endl;
+    return fileInfos;  // Return the files with their sizes and identities
+}
+
 // Method to calculate the total size of a directory
 uintmax_t ProcessingEngine::calculateDirectorySize(const std::filesystem::path& directory) {
     uintmax_t size = 0;
@@ -495,8 +1530,308 @@ void ProcessingEngine::deleteDirectory(const std::filesystem::path& directory) {
     std::filesystem::remove_all(directory);  // Recursively delete the directory
 }
 
-// Placeholder method for searching files (to be implemented)
-void ProcessingEngine::searchFiles() {
-    // TO-DO implement search files
-    // Placeholder for future implementation of search functionality
+// AND search: every term must occur in a document, and a document scores the sum of the
+// frequencies of the terms. Postings are sorted by document number, so the lists are
+// intersected smallest first: the smallest list is decoded into the candidate set, which
+// only shrinks, and every longer list is probed block by block through its skip table.
+void ProcessingEngine::searchFiles(const std::vector<std::string>& terms) {
+    auto searchStart = std::chrono::high_resolution_clock::now();
+
+    std::vector<PostingsView> termPostings;
+    bool missingTerm = false;
+    for (const std::string& term : terms) {
+        PostingsView postings;
+        if (!indexStore.findPostings(term, postings)) {
+            missingTerm = true;
+            break;
+        }
+        termPostings.push_back(postings);
+    }
+
+    std::vector<DocFreqPair> results;
+    if (!missingTerm && !termPostings.empty()) {
+        std::sort(termPostings.begin(), termPostings.end(), [](const PostingsView& a, const PostingsView& b) {
+            return a.size() < b.size();
+        });
+        termPostings[0].decode(results);
+        for (size_t i = 1; i < termPostings.size() && !results.empty(); ++i) {
+            intersectPostings(results, termPostings[i], blockSeekKernel);
+        }
+
+        // Top results by score, ties in document order
+        size_t top = std::min(results.size(), searchResultCount);
+        std::partial_sort(results.begin(), results.begin() + top, results.end(),
+                          [](const DocFreqPair& a, const DocFreqPair& b) {
+                              if (a.wordFrequency != b.wordFrequency) {
+                                  return a.wordFrequency > b.wordFrequency;
+                              }
+                              return a.documentNumber < b.documentNumber;
+                          });
+        results.resize(top);
+    }
+
+    std::chrono::duration<double, std::micro> searchDuration = std::chrono::high_resolution_clock::now() - searchStart;
+    std::cout << "Search completed in " << searchDuration.count() << " microseconds" << std::endl;
+    std::cout << "Search results (top " << searchResultCount << "):" << std::endl;
+    for (const DocFreqPair& result : results) {
+        std::cout << "* " << indexStore.getDocument(result.documentNumber) << " " << result.wordFrequency << std::endl;
+    }
+}
+
+void ProcessingEngine::saveIndex(const std::string& path) {
+    auto saveStart = std::chrono::high_resolution_clock::now();
+    std::string error;
+    if (!indexStore.save(path, error)) {
+        std::cerr << "Error: could not save the index: " << error << std::endl;
+        return;
+    }
+    std::chrono::duration<double, std::milli> saveDuration = std::chrono::high_resolution_clock::now() - saveStart;
+    std::cout << "Saved index with " << indexStore.termCount() << " terms in " << indexStore.documentCount()
+              << " documents to " << path << " (" << std::filesystem::file_size(path) << " bytes) in "
+              << saveDuration.count() << " ms" << std::endl;
+}
+
+// The image is mapped, not read: loading costs a checksum pass over the file, and the
+// pages of postings a search touches are faulted in on demand
+void ProcessingEngine::loadIndex(const std::string& path) {
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    std::string error;
+    if (!indexStore.load(path, error)) {
+        std::cerr << "Error: could not load the index from " << path << ": " << error << std::endl;
+        return;
+    }
+    std::chrono::duration<double, std::milli> loadDuration = std::chrono::high_resolution_clock::now() - loadStart;
+    std::cout << "Loaded index with " << indexStore.termCount() << " terms in " << indexStore.documentCount()
+              << " documents from " << path << " (" << indexStore.imageBytes() << " bytes) in "
+              << loadDuration.count() << " ms" << std::endl;
+}
+
+// Tokenizer benchmark: every strategy (and every branchless kernel the CPU can run)
+// tokenizes the same files, held in memory so no strategy pays for I/O. Each run starts
+// from a fresh copy, because in-place tokenizers overwrite delimiters. Runs are single
+// threaded, so the numbers compare the tokenizers and not the scheduling. Besides the
+// token count, every run is checked against the first by a hash of the token sequence.
+void ProcessingEngine::benchTokenizers(const std::string& path) {
+    std::vector<CrawledFile> crawledFiles = crawlDataset(path);
+    std::sort(crawledFiles.begin(), crawledFiles.end(), [](const CrawledFile& a, const CrawledFile& b) {
+        return a.path < b.path;
+    });
+
+    // Load the dataset into one buffer; files are separated by their offsets
+    std::vector<char> dataset;
+    std::vector<std::pair<size_t, size_t>> files;  // Offset and size of every file
+    for (const CrawledFile& file : crawledFiles) {
+        int fd = open(file.path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            std::cerr << "Error opening file: " << file.path << " - " << strerror(errno) << std::endl;
+            continue;
+        }
+        size_t offset = dataset.size();
+        dataset.resize(offset + file.size);
+        size_t loaded = 0;
+        while (loaded < file.size) {
+            ssize_t bytes = read(fd, dataset.data() + offset + loaded, file.size - loaded);
+            if (bytes <= 0) {
+                break;
+            }
+            loaded += static_cast<size_t>(bytes);
+        }
+        close(fd);
+        dataset.resize(offset + loaded);
+        files.emplace_back(offset, loaded);
+    }
+
+    char charDict[256];
+    initializeCharDict(charDict);
+
+    std::vector<std::pair<std::string, TokenizerKernelSet>> strategies;
+    __builtin_cpu_init();
+    strategies.emplace_back("branchless/scalar", selectTokenizerKernels("scalar", options.tokenChars));
+    if (__builtin_cpu_supports("avx2")) {
+        strategies.emplace_back("branchless/avx2", selectTokenizerKernels("avx2", options.tokenChars));
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        strategies.emplace_back("branchless/avx512", selectTokenizerKernels("avx512", options.tokenChars));
+    }
+    for (const std::string& name : tokenizerStrategyNames()) {
+        if (name != "branchless") {
+            strategies.emplace_back(name, selectTokenizer(name, options.simd, options.tokenChars));
+        }
+    }
+
+    std::cout << "Tokenizer benchmark: " << files.size() << " files, " << dataset.size()
+              << " bytes in memory, 1 thread" << std::endl;
+
+    std::vector<char> work(dataset.size());
+    std::vector<char*> tokens;
+    size_t referenceTokens = 0;
+    uint64_t referenceHash = 0;
+    for (size_t s = 0; s < strategies.size(); ++s) {
+        const auto& [name, strategy] = strategies[s];
+        std::copy(dataset.begin(), dataset.end(), work.begin());
+
+        size_t tokenCount = 0;
+        uint64_t tokenHash = 0;
+        double seconds = 0.0;
+        for (const auto& [offset, size] : files) {
+            char* buffer = work.data() + offset;
+            tokens.clear();
+            auto start = std::chrono::high_resolution_clock::now();
+            strategy.tokenize(buffer, size, charDict, nibbleTables, tokens);
+            std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+            seconds += duration.count();
+
+            // Outside the timed region: fold the tokens into an order-sensitive hash
+            tokenCount += tokens.size();
+            for (const char* token : tokens) {
+                size_t length = strnlen(token, static_cast<size_t>(buffer + size - token));
+                tokenHash = tokenHash * 31 + hashTerm(token, length);
+            }
+        }
+
+        // Counting only: the same scan over the untouched dataset, storing no tokens
+        size_t countedTokens = 0;
+        auto countStart = std::chrono::high_resolution_clock::now();
+        for (const auto& [offset, size] : files) {
+            countedTokens += strategy.countTokens(dataset.data() + offset, size, charDict, nibbleTables);
+        }
+        std::chrono::duration<double> countDuration = std::chrono::high_resolution_clock::now() - countStart;
+
+        if (s == 0) {
+            referenceTokens = tokenCount;
+            referenceHash = tokenHash;
+        }
+        bool agrees = tokenCount == referenceTokens && tokenHash == referenceHash && countedTokens == tokenCount;
+        double megabytes = static_cast<double>(dataset.size()) / (1024.0 * 1024.0);
+        double throughput = seconds > 0.0 ? megabytes / seconds : 0.0;
+        double countThroughput = countDuration.count() > 0.0 ? megabytes / countDuration.count() : 0.0;
+        std::cout << "* " << name << ": " << seconds << " seconds, " << throughput << " MB/s, "
+                  << tokenCount << " tokens, " << countThroughput << " MB/s counting only, "
+                  << (agrees ? "agrees" : "DIFFERS from " + strategies[0].first) << std::endl;
+    }
+}
+
+void ProcessingEngine::generateCorpus(const std::string& root, const std::vector<std::string>& settings) {
+    CorpusSpec spec;
+    for (const std::string& setting : settings) {
+        if (!CorpusGenerator::parseSetting(setting, spec)) {
+            std::cerr << "Error: invalid corpus setting " << setting << std::endl;
+            return;
+        }
+    }
+    CorpusGenerator generator(spec, numThreads);
+    CorpusStats stats;
+    std::string error;
+    if (!generator.generate(root, stats, error)) {
+        std::cerr << "Error: could not generate the corpus: " << error << std::endl;
+        return;
+    }
+    std::cout << "Generated " << stats.files << " files (" << stats.bytes << " bytes) in " << stats.directories
+              << " directories below " << root << " in " << stats.seconds << " seconds" << std::endl;
+}
+
+void ProcessingEngine::sweep(const std::string& path, const std::vector<std::string>& settings) {
+    SweepSpec spec;
+    for (const std::string& setting : settings) {
+        if (!BenchmarkHarness::parseSetting(setting, spec)) {
+            std::cerr << "Error: invalid sweep setting " << setting << std::endl;
+            return;
+        }
+    }
+    BenchmarkHarness harness(options);
+    std::string error;
+    if (!harness.sweep(path, spec, error)) {
+        std::cerr << "Error: sweep failed: " << error << std::endl;
+    }
+}
+
+// Print the tokenize-loop counters of every thread and of all threads together, as
+// IPC and events per KB tokenized. Events a thread could not count are shown as n/a.
+void ProcessingEngine::reportPerfCounts(const std::vector<PerfCounts>& perfCounts,
+                                        const StatsRegistry& statsRegistry) {
+    std::vector<uintmax_t> bytesProcessed(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        bytesProcessed[i] = statsRegistry.snapshot(i)[StatBytes];
+    }
+    PerfCounts total;
+    uintmax_t totalBytes = 0;
+    for (int i = 0; i < numThreads; ++i) {
+        total.add(perfCounts[i]);
+        totalBytes += perfCounts[i].any ? bytesProcessed[i] : 0;
+    }
+    if (!total.any) {
+        PerfCounters probe;  // Open a set here only to learn why the workers could not
+        std::cout << "Performance counters unavailable: "
+                  << (probe.available() ? "no counts were collected" : probe.error()) << std::endl;
+        return;
+    }
+
+    auto printCounts = [](const std::string& label, const PerfCounts& counts, uintmax_t bytes) {
+        double kilobytes = static_cast<double>(bytes) / 1024.0;
+        std::cout << label << ":";
+        if (counts.valid[PerfCycles] && counts.valid[PerfInstructions] && counts.values[PerfCycles] != 0) {
+            std::cout << " IPC " << static_cast<double>(counts.values[PerfInstructions]) / counts.values[PerfCycles];
+        } else {
+            std::cout << " IPC n/a";
+        }
+        for (int event = PerfCycles; event < perfEventCount; ++event) {
+            std::cout << ", " << PerfCounters::eventName(event) << "/KB ";
+            if (counts.valid[event] && kilobytes > 0.0) {
+                std::cout << static_cast<double>(counts.values[event]) / kilobytes;
+            } else {
+                std::cout << "n/a";
+            }
+        }
+        std::cout << std::endl;
+    };
+
+    for (int i = 0; i < numThreads; ++i) {
+        if (perfCounts[i].any) {
+            printCounts("Thread " + std::to_string(i + 1) + " tokenize counters", perfCounts[i], bytesProcessed[i]);
+        }
+    }
+    printCounts("Tokenize counters (" + kernels.name + ", user space)", total, totalBytes);
+}
+
+// Write the metrics of an index run in the format chosen with --metrics, to the
+// --metrics-output file or after the report on standard output
+void ProcessingEngine::writeMetrics(const RunMetrics& metrics) {
+    std::ofstream file;
+    if (!options.metricsOutput.empty()) {
+        file.open(options.metricsOutput, std::ios::trunc);
+        if (!file) {
+            std::lock_guard<std::mutex> guard(cout_mutex);
+            std::cerr << "Cannot write metrics to " << options.metricsOutput << std::endl;
+            return;
+        }
+    }
+    std::ostream& out = options.metricsOutput.empty() ? std::cout : file;
+    if (options.metrics == "csv") {
+        writeMetricsCsv(metrics, out);
+    } else {
+        writeMetricsJson(metrics, out);
+    }
+}
+
+// Print indexing progress every --progress seconds until done is set. Reads only the
+// registry snapshots, so the workers never wait for the reporter.
+void ProcessingEngine::reportProgress(const StatsRegistry& statsRegistry, uintmax_t totalBytes, std::mutex& doneMutex,
+                                      std::condition_variable& doneSignal, const bool& done) {
+    auto interval = std::chrono::seconds(options.progressSeconds);
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t lastBytes = 0;
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    while (!doneSignal.wait_for(lock, interval, [&done]() { return done; })) {
+        WorkerStats total = statsRegistry.total();
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        double intervalMB = static_cast<double>(total[StatBytes] - lastBytes) / (1024.0 * 1024.0);
+        lastBytes = total[StatBytes];
+
+        std::lock_guard<std::mutex> guard(cout_mutex);
+        std::cout << "Progress after " << elapsed.count() << " s: " << total[StatFiles] << " files, "
+                  << total[StatBytes] << " of " << totalBytes << " bytes ("
+                  << (totalBytes ? 100.0 * total[StatBytes] / totalBytes : 100.0) << "%), " << total[StatTokens]
+                  << " tokens, " << intervalMB / options.progressSeconds << " MB/s" << std::endl;
+    }
 }
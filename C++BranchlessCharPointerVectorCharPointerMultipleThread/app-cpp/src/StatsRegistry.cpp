@@ -0,0 +1,43 @@
+// StatsRegistry.cpp
+
+#include "StatsRegistry.hpp"
+
+void WorkerStats::add(const WorkerStats& other) {
+    for (int stat = 0; stat < workerStatCount; ++stat) {
+        values[stat] += other.values[stat];
+    }
+}
+
+StatsRegistry::StatsRegistry(size_t threads) {
+    this->slotCount = threads;
+    this->slots.reset(new Slot[threads]);
+    for (size_t thread = 0; thread < threads; ++thread) {
+        for (std::atomic<uint64_t>& value : slots[thread].values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void StatsRegistry::publish(size_t thread, const WorkerStats& stats) {
+    Slot& slot = slots[thread];
+    for (int stat = 0; stat < workerStatCount; ++stat) {
+        slot.values[stat].store(stats.values[stat], std::memory_order_relaxed);
+    }
+}
+
+WorkerStats StatsRegistry::snapshot(size_t thread) const {
+    WorkerStats stats;
+    const Slot& slot = slots[thread];
+    for (int stat = 0; stat < workerStatCount; ++stat) {
+        stats.values[stat] = slot.values[stat].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+WorkerStats StatsRegistry::total() const {
+    WorkerStats sum;
+    for (size_t thread = 0; thread < slotCount; ++thread) {
+        sum.add(snapshot(thread));
+    }
+    return sum;
+}
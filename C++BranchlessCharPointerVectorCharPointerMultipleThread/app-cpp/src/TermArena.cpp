@@ -0,0 +1,34 @@
+// TermArena.cpp
+
+#include "TermArena.hpp"
+#include <cstring>       // For memcpy
+
+const char* TermArena::store(const char* term, size_t length) {
+    if (length > remaining) {
+        // Start a new block; a term longer than a block gets a block of its own
+        size_t size = length > nextBlockSize ? length : nextBlockSize;
+        if (nextBlockSize < maxBlockSize) {
+            nextBlockSize *= 2;
+        }
+        blocks.emplace_back(new char[size]);
+        cursor = blocks.back().get();
+        remaining = size;
+        reservedBytes += size;
+    }
+    char* copy = cursor;
+    memcpy(copy, term, length);
+    cursor += length;
+    remaining -= length;
+    usedBytes += length;
+    return copy;
+}
+
+void TermArena::clear() {
+    blocks.clear();
+    blocks.shrink_to_fit();
+    cursor = nullptr;
+    remaining = 0;
+    usedBytes = 0;
+    reservedBytes = 0;
+    nextBlockSize = firstBlockSize;
+}
@@ -0,0 +1,49 @@
+// TokenClasses.cpp
+
+#include "TokenClasses.hpp"
+
+namespace {
+
+const std::string customPrefix = "custom:";
+
+// Copy a compile-time table into a charDict
+void copyCharTable(const CharTable& table, char charDict[256]) {
+    for (int c = 0; c < 256; ++c) {
+        charDict[c] = table[c];
+    }
+}
+
+} // namespace
+
+const std::vector<std::string>& tokenCharClassNames() {
+    static const std::vector<std::string> names = {"alnum", "alnum-underscore", "alnum-apostrophe"};
+    return names;
+}
+
+bool isTokenCharClass(const std::string& tokenChars) {
+    if (tokenChars.compare(0, customPrefix.size(), customPrefix) == 0) {
+        return true;
+    }
+    for (const std::string& name : tokenCharClassNames()) {
+        if (tokenChars == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool buildCharTable(const std::string& tokenChars, char charDict[256]) {
+    copyCharTable(TokenCharTables<AlnumTokenChars>::table, charDict);
+    if (tokenChars == "alnum-underscore") {
+        copyCharTable(TokenCharTables<AlnumUnderscoreTokenChars>::table, charDict);
+    } else if (tokenChars == "alnum-apostrophe") {
+        copyCharTable(TokenCharTables<AlnumApostropheTokenChars>::table, charDict);
+    } else if (tokenChars.compare(0, customPrefix.size(), customPrefix) == 0) {
+        for (size_t i = customPrefix.size(); i < tokenChars.size(); ++i) {
+            charDict[static_cast<unsigned char>(tokenChars[i])] = ~0;
+        }
+    } else if (tokenChars != "alnum") {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+// TokenizerKernels.cpp
+
+#include "TokenizerKernels.hpp"
+#include "TokenizerSinks.hpp"
+
+namespace {
+
+// The vector kernels are the sink templates with appending sinks; the count kernels are
+// the read-only templates with a counter, so they only scan. Each is instantiated once
+// per token character class.
+
+template <typename Chars>
+void tokenizeScalar(char* buffer, size_t size, const char charDict[256],
+                    const NibbleTables& tables, std::vector<char*>& tokens) {
+    TokenAppender sink{tokens};
+    tokenizeScalarInto<Chars>(buffer, size, charDict, tables, sink);
+}
+
+template <typename Chars>
+void tokenizeAvx2(char* buffer, size_t size, const char charDict[256],
+                  const NibbleTables& tables, std::vector<char*>& tokens) {
+    TokenAppender sink{tokens};
+    tokenizeAvx2Into<Chars>(buffer, size, charDict, tables, sink);
+}
+
+template <typename Chars>
+void tokenizeAvx512(char* buffer, size_t size, const char charDict[256],
+                    const NibbleTables& tables, std::vector<char*>& tokens) {
+    TokenAppender sink{tokens};
+    tokenizeAvx512Into<Chars>(buffer, size, charDict, tables, sink);
+}
+
+template <typename Chars>
+void tokenizeSpansScalar(const char* buffer, size_t size, const char charDict[256],
+                         const NibbleTables& tables, std::vector<TokenSpan>& spans) {
+    SpanAppender sink{spans};
+    tokenizeSpansScalarInto<Chars>(buffer, size, charDict, tables, sink);
+}
+
+template <typename Chars>
+void tokenizeSpansAvx2(const char* buffer, size_t size, const char charDict[256],
+                       const NibbleTables& tables, std::vector<TokenSpan>& spans) {
+    SpanAppender sink{spans};
+    tokenizeSpansAvx2Into<Chars>(buffer, size, charDict, tables, sink);
+}
+
+template <typename Chars>
+void tokenizeSpansAvx512(const char* buffer, size_t size, const char charDict[256],
+                         const NibbleTables& tables, std::vector<TokenSpan>& spans) {
+    SpanAppender sink{spans};
+    tokenizeSpansAvx512Into<Chars>(buffer, size, charDict, tables, sink);
+}
+
+template <typename Chars>
+size_t countTokensScalar(const char* buffer, size_t size, const char charDict[256], const NibbleTables& tables) {
+    TokenCounter sink;
+    tokenizeSpansScalarInto<Chars>(buffer, size, charDict, tables, sink);
+    return sink.count;
+}
+
+template <typename Chars>
+size_t countTokensAvx2(const char* buffer, size_t size, const char charDict[256], const NibbleTables& tables) {
+    TokenCounter sink;
+    tokenizeSpansAvx2Into<Chars>(buffer, size, charDict, tables, sink);
+    return sink.count;
+}
+
+template <typename Chars>
+size_t countTokensAvx512(const char* buffer, size_t size, const char charDict[256], const NibbleTables& tables) {
+    TokenCounter sink;
+    tokenizeSpansAvx512Into<Chars>(buffer, size, charDict, tables, sink);
+    return sink.count;
+}
+
+} // namespace
+
+TokenizerKernelSet selectTokenizerKernels(const std::string& requested, const std::string& tokenChars) {
+    __builtin_cpu_init();
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+    bool hasAvx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+
+    return visitTokenChars(tokenChars, [&](auto tag) -> TokenizerKernelSet {
+        using Chars = typename decltype(tag)::type;
+        if ((requested == "auto" || requested == "avx512") && hasAvx512) {
+            return {tokenizeAvx512<Chars>, tokenizeSpansAvx512<Chars>, countTokensAvx512<Chars>, "avx512"};
+        }
+        if ((requested == "auto" || requested == "avx2" || requested == "avx512") && hasAvx2) {
+            return {tokenizeAvx2<Chars>, tokenizeSpansAvx2<Chars>, countTokensAvx2<Chars>, "avx2"};
+        }
+        return {tokenizeScalar<Chars>, tokenizeSpansScalar<Chars>, countTokensScalar<Chars>, "scalar"};
+    });
+}
@@ -0,0 +1,170 @@
+// TokenizerStrategies.cpp
+
+#include "TokenizerStrategies.hpp"
+#include "TokenizerSinks.hpp"
+#include <cstdio>        // For snprintf
+#include <cstring>       // For memcmp, memcpy
+#include <regex>         // For std::regex
+
+// strtok_r keeps a 256-entry delimiter set for strspn/strcspn; the charDict is that set,
+// or for a fixed token character class the constexpr test that replaces it
+template <typename Chars>
+static inline bool isDelimiter(const char charDict[256], char c) {
+    return classifyChar<Chars>(charDict, (unsigned char)c) == 0;
+}
+
+// In-place strtok loop over any sink (see TokenizerSinks.hpp)
+template <typename Chars, typename Sink>
+static void strtokInto(char* buffer, size_t size, const char charDict[256], Sink& sink) {
+    size_t i = 0;
+    while (i < size) {
+        // strspn: skip the delimiters before the token
+        while (i < size && isDelimiter<Chars>(charDict, buffer[i])) {
+            ++i;
+        }
+        if (i == size) {
+            break;
+        }
+        sink.token(&buffer[i]);
+        // strcspn: find the end of the token and terminate it
+        while (i < size && !isDelimiter<Chars>(charDict, buffer[i])) {
+            ++i;
+        }
+        if (i < size) {
+            buffer[i++] = '\0';
+        }
+    }
+}
+
+template <typename Chars, typename Sink>
+static void strtokSpansInto(const char* buffer, size_t size, const char charDict[256], Sink& sink) {
+    size_t i = 0;
+    while (i < size) {
+        while (i < size && isDelimiter<Chars>(charDict, buffer[i])) {
+            ++i;
+        }
+        size_t start = i;
+        while (i < size && !isDelimiter<Chars>(charDict, buffer[i])) {
+            ++i;
+        }
+        if (i > start) {
+            sink.span(buffer + start, i - start);
+        }
+    }
+}
+
+// Pattern matching one run of token characters: a bracket expression listing every
+// byte the charDict marks as a token character. Each thread builds and compiles it once
+// per charDict, because compiling a std::regex costs far more than tokenizing a small
+// file; later calls only compare the 256 charDict bytes with the cached copy.
+static const std::regex& tokenPattern(const char charDict[256]) {
+    thread_local bool cached = false;
+    thread_local char cachedDict[256];
+    thread_local std::regex cachedPattern;
+
+    if (cached && memcmp(cachedDict, charDict, sizeof(cachedDict)) == 0) {
+        return cachedPattern;
+    }
+
+    std::string source = "[";
+    for (int c = 1; c < 256; ++c) {
+        if (charDict[c] != 0) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\x%02x", c);
+            source += escaped;
+        }
+    }
+    source += "]+";
+    cachedPattern = std::regex(source, std::regex::ECMAScript | std::regex::optimize);
+    memcpy(cachedDict, charDict, sizeof(cachedDict));
+    cached = true;
+    return cachedPattern;
+}
+
+template <typename Sink>
+static void regexInto(char* buffer, size_t size, const char charDict[256], Sink& sink) {
+    const std::regex& pattern = tokenPattern(charDict);
+    for (std::cregex_iterator match(buffer, buffer + size, pattern), end; match != end; ++match) {
+        size_t start = static_cast<size_t>(match->position());
+        size_t stop = start + static_cast<size_t>(match->length());
+        sink.token(buffer + start);
+        // The byte after a match is a delimiter, so terminating the token there does not
+        // change what the iterator finds next
+        if (stop < size) {
+            buffer[stop] = '\0';
+        }
+    }
+}
+
+template <typename Sink>
+static void regexSpansInto(const char* buffer, size_t size, const char charDict[256], Sink& sink) {
+    const std::regex& pattern = tokenPattern(charDict);
+    for (std::cregex_iterator match(buffer, buffer + size, pattern), end; match != end; ++match) {
+        sink.span(buffer + match->position(), static_cast<size_t>(match->length()));
+    }
+}
+
+template <typename Chars>
+static void tokenizeStrtok(char* buffer, size_t size, const char charDict[256],
+                           const NibbleTables& tables, std::vector<char*>& tokens) {
+    (void)tables;
+    TokenAppender sink{tokens};
+    strtokInto<Chars>(buffer, size, charDict, sink);
+}
+
+template <typename Chars>
+static void tokenizeSpansStrtok(const char* buffer, size_t size, const char charDict[256],
+                                const NibbleTables& tables, std::vector<TokenSpan>& spans) {
+    (void)tables;
+    SpanAppender sink{spans};
+    strtokSpansInto<Chars>(buffer, size, charDict, sink);
+}
+
+template <typename Chars>
+static size_t countTokensStrtok(const char* buffer, size_t size, const char charDict[256],
+                                const NibbleTables& tables) {
+    (void)tables;
+    TokenCounter sink;
+    strtokSpansInto<Chars>(buffer, size, charDict, sink);
+    return sink.count;
+}
+
+void tokenizeRegex(char* buffer, size_t size, const char charDict[256],
+                   const NibbleTables& tables, std::vector<char*>& tokens) {
+    (void)tables;
+    TokenAppender sink{tokens};
+    regexInto(buffer, size, charDict, sink);
+}
+
+void tokenizeSpansRegex(const char* buffer, size_t size, const char charDict[256],
+                        const NibbleTables& tables, std::vector<TokenSpan>& spans) {
+    (void)tables;
+    SpanAppender sink{spans};
+    regexSpansInto(buffer, size, charDict, sink);
+}
+
+size_t countTokensRegex(const char* buffer, size_t size, const char charDict[256], const NibbleTables& tables) {
+    (void)tables;
+    TokenCounter sink;
+    regexSpansInto(buffer, size, charDict, sink);
+    return sink.count;
+}
+
+const std::vector<std::string>& tokenizerStrategyNames() {
+    static const std::vector<std::string> names = {"branchless", "strtok", "regex"};
+    return names;
+}
+
+TokenizerKernelSet selectTokenizer(const std::string& strategy, const std::string& simd,
+                                   const std::string& tokenChars) {
+    if (strategy == "strtok") {
+        return visitTokenChars(tokenChars, [](auto tag) -> TokenizerKernelSet {
+            using Chars = typename decltype(tag)::type;
+            return {tokenizeStrtok<Chars>, tokenizeSpansStrtok<Chars>, countTokensStrtok<Chars>, "strtok"};
+        });
+    }
+    if (strategy == "regex") {
+        return {tokenizeRegex, tokenizeSpansRegex, countTokensRegex, "regex"};
+    }
+    return selectTokenizerKernels(simd, tokenChars);
+}
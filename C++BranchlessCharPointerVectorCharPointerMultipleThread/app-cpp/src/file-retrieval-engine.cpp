@@ -4,14 +4,127 @@
 #include <thread>
 #include "ProcessingEngine.hpp"
 #include "AppInterface.hpp"
+#include "TokenClasses.hpp"
 #include <cstdlib> // For std::atoi
+#include <string>
+
+// Parse one "--name=value" option into the engine settings, returns false if it is not recognized
+static bool parseOption(const std::string& arg, EngineOptions& options)
+{
+    if (arg.rfind("--", 0) != 0) {
+        return false;
+    }
+    // Options without "=value" are switches
+    size_t equals = arg.find('=');
+    std::string name = arg.substr(2, equals == std::string::npos ? std::string::npos : equals - 2);
+    std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+
+    bool isNumber = !value.empty() && value.find_first_not_of("0123456789") == std::string::npos;
+
+    if (name == "max-resident-mb" && isNumber) {
+        options.maxResidentBytes = std::strtoull(value.c_str(), nullptr, 10) * 1024 * 1024;
+        return true;
+    }
+    if (name == "chunk-mb" && isNumber) {
+        options.chunkBytes = std::strtoull(value.c_str(), nullptr, 10) * 1024 * 1024;
+        return true;
+    }
+    if (name == "mem-policy") {
+        if (value == "local") {
+            options.memPolicy = MemPolicy::Local;
+        } else if (value == "interleave") {
+            options.memPolicy = MemPolicy::Interleave;
+        } else if (value == "first-touch-by-consumer") {
+            options.memPolicy = MemPolicy::FirstTouchByConsumer;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    if (name == "verify-placement" && value.empty()) {
+        options.verifyPlacement = true;
+        return true;
+    }
+    if (name == "input" && (value == "read" || value == "mmap")) {
+        options.input = value;
+        return true;
+    }
+    if (name == "mmap-populate" && value.empty()) {
+        options.mmapPopulate = true;
+        return true;
+    }
+    if (name == "loader" && (value == "sync" || value == "uring")) {
+        options.loader = value;
+        return true;
+    }
+    if (name == "io-depth" && isNumber && std::strtoul(value.c_str(), nullptr, 10) > 0) {
+        options.ioDepth = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        return true;
+    }
+    if (name == "direct-io" && value.empty()) {
+        options.directIo = true;
+        return true;
+    }
+    if (name == "perf-counters" && value.empty()) {
+        options.perfCounters = true;
+        return true;
+    }
+    if (name == "metrics" && (value == "json" || value == "csv")) {
+        options.metrics = value;
+        return true;
+    }
+    if (name == "metrics-output" && !value.empty()) {
+        options.metricsOutput = value;
+        return true;
+    }
+    if (name == "progress" && isNumber) {
+        options.progressSeconds = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        return true;
+    }
+    if (name == "tokenizer") {
+        for (const std::string& strategy : tokenizerStrategyNames()) {
+            if (value == strategy) {
+                options.tokenizer = value;
+                return true;
+            }
+        }
+        return false;
+    }
+    if (name == "token-chars" && isTokenCharClass(value)) {
+        options.tokenChars = value;
+        return true;
+    }
+    if (name == "simd" && (value == "auto" || value == "scalar" || value == "avx2" || value == "avx512")) {
+        options.simd = value;
+        return true;
+    }
+    return false;
+}
 
 int main(int argc, char** argv)
 {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <number of threads> <affinityFlag>" << std::endl;
-        std::cerr << "Example: " << argv[0] << " 4 1" << std::endl;
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <number of threads> <affinityFlag> [options]" << std::endl;
+        std::cerr << "Example: " << argv[0] << " 4 1 --max-resident-mb=512" << std::endl;
         std::cerr << "       affinityFlag: 1 to enable affinity, 0 to disable" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "       --max-resident-mb=N  memory budget for loaded files in MB (0 = unlimited)" << std::endl;
+        std::cerr << "       --chunk-mb=N         split files larger than N MB across workers (default 64, 0 = never)" << std::endl;
+        std::cerr << "       --mem-policy=POLICY  buffer placement: local, interleave, first-touch-by-consumer (default local)" << std::endl;
+        std::cerr << "       --verify-placement   report the fraction of bytes tokenized from local memory" << std::endl;
+        std::cerr << "       --input=MODE         read (copy into buffers) or mmap (zero-copy, read-only) (default read)" << std::endl;
+        std::cerr << "       --mmap-populate      prefault mapped files with MAP_POPULATE" << std::endl;
+        std::cerr << "       --loader=MODE        file loader: sync or uring (default sync)" << std::endl;
+        std::cerr << "       --io-depth=N         files in flight per node with --loader=uring (default 32)" << std::endl;
+        std::cerr << "       --direct-io          read with O_DIRECT into aligned buffers, bypassing the page cache" << std::endl;
+        std::cerr << "       --perf-counters      count cycles, instructions, branch and cache misses of the tokenize loop" << std::endl;
+        std::cerr << "       --metrics=FORMAT     write phase times and latency histograms after indexing: json or csv" << std::endl;
+        std::cerr << "       --metrics-output=F   write the metrics to file F instead of standard output" << std::endl;
+        std::cerr << "       --progress=N         print indexing progress every N seconds (default 0 = never)" << std::endl;
+        std::cerr << "       --tokenizer=NAME     tokenizer strategy: branchless, strtok, regex (default branchless)" << std::endl;
+        std::cerr << "       --simd=KERNEL        branchless tokenizer kernel: auto, scalar, avx2, avx512 (default auto)" << std::endl;
+        std::cerr << "       --token-chars=CLASS  token characters: alnum, alnum-underscore, alnum-apostrophe or custom:CHARS" << std::endl;
+        std::cerr << "                            (letters, digits and CHARS) (default alnum)" << std::endl;
         return 1;
     }
 
@@ -27,7 +140,15 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    std::shared_ptr<ProcessingEngine> engine = std::make_shared<ProcessingEngine>(numThreads, affinityFlag);
+    EngineOptions options;
+    for (int i = 3; i < argc; ++i) {
+        if (!parseOption(argv[i], options)) {
+            std::cerr << "Error: Unrecognized option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::shared_ptr<ProcessingEngine> engine = std::make_shared<ProcessingEngine>(numThreads, affinityFlag, options);
     std::shared_ptr<AppInterface> interface = std::make_shared<AppInterface>(engine);
 
     interface->readCommands();